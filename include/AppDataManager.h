@@ -3,17 +3,49 @@
 
 #include <QObject>
 #include <QString>
+#include <QList>
+#include <QDate>
+
+#include "MistakeStore.h"
+#include "SearchIndex.h"
+#include "DayIndex.h"
+
+struct LogEntry {
+    QString time;
+    QString text;
+};
 
 class AppDataManager : public QObject {
     Q_OBJECT
 public:
     explicit AppDataManager(QObject *parent = nullptr);
     void writeTranslationLog(const QString &inputText);
-    void writeMistakesReport(const QString &report);
-    void writeMistakesReport(const QString &report, const QString &dateString);
+    void writeMistakesReport(const QString &report, const QString &dateString, bool openFolder = true);
+    void writeMistakesReport(const QList<MistakeRecord> &mistakes, const QString &dateString, bool openFolder = true);
+    static QString getReportFilePath(const QString &dateString);
+    bool hasUpToDateReport(const QString &dateString) const;
+    // The report as a file that can be opened, extracted to a temporary file when archived
+    QString openableReportPath(const QString &dateString) const;
+    MistakeStore *mistakeStore() const;
+    SearchIndex *searchIndex() const;
+    DayIndex *dayIndex() const;
+    static QString formatMistakesReport(const QList<MistakeRecord> &mistakes);
     static QString getAppDataPath();
+    static QString getArchivePath();
+    static int archiveOldLogs(int maxAgeDays);
+    static QStringList recentDayFiles(int maxDays);
+    static QStringList loggedInputs(int maxCount);
+    // Date of a day log or report file name, invalid for any other file
+    static QDate parseDayFileName(const QString &fileName, bool *isReport = nullptr);
+    // The entries of a day log as written by writeTranslationLog, oldest first
+    static QList<LogEntry> splitLogEntries(const QString &content);
     QString getTodaysFileContent() const;
     QString getFileContentForDate(const QString &dateString) const;
+
+private:
+    MistakeStore *mistakes;
+    SearchIndex *search;
+    DayIndex *days;
 };
 
 #endif // APPDATAMANAGER_H 
\ No newline at end of file
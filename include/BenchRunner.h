@@ -0,0 +1,71 @@
+#ifndef BENCHRUNNER_H
+#define BENCHRUNNER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QQueue>
+#include <QVector>
+
+#include "RequestWorker.h"
+
+class KeyChainClass;
+
+// Sends a corpus of the user's own logged inputs through every model and prompt
+// combination and prints latency, time to first token and token usage side by side.
+class BenchRunner : public QObject {
+    Q_OBJECT
+public:
+    struct Config {
+        QStringList models;
+        QStringList promptFiles; // Empty means the prompt from the settings
+        QString task = "translation"; // translation, feedback or report
+        int samples = 20;
+        int concurrency = 2;
+    };
+
+    explicit BenchRunner(const Config &config, QObject *parent = nullptr);
+    void start();
+
+signals:
+    void finished(bool ok);
+
+private:
+    struct Combination {
+        QString model;
+        QString promptLabel;
+        QString prompt;
+        QVector<qint64> latencies;
+        QVector<qint64> firstTokens;
+        qint64 promptTokens = 0;
+        qint64 cachedTokens = 0;
+        qint64 completionTokens = 0;
+        qint64 contentChars = 0;
+        int succeeded = 0;
+        int failed = 0;
+    };
+    struct Job {
+        int combination;
+        QString input;
+    };
+
+    bool prepare();
+    void run(const QString &apiKey);
+    void launchNext();
+    RequestSpec specFor(const Job &job) const;
+    void printReport();
+    static qint64 percentile(QVector<qint64> values, double p);
+
+    Config config;
+    QList<Combination> combinations;
+    QQueue<Job> jobs;
+    QString apiKey;
+    QString sourceLang;
+    QString targetLang;
+    int running;
+    int total;
+    KeyChainClass *keychain;
+};
+
+#endif // BENCHRUNNER_H
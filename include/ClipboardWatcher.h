@@ -0,0 +1,45 @@
+#ifndef CLIPBOARDWATCHER_H
+#define CLIPBOARDWATCHER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QClipboard>
+#include <QTimer>
+#include <QList>
+
+class LanguageIdentifier;
+
+// Watches the clipboard and the X11 primary selection and reports newly copied prose in one
+// of the configured languages. Copies are debounced and deduplicated, and anything that looks
+// like code, a URL, a single token such as a password, or comes from a password manager is ignored.
+class ClipboardWatcher : public QObject {
+    Q_OBJECT
+public:
+    ClipboardWatcher(LanguageIdentifier *languageIdentifier, QObject *parent = nullptr);
+    void setEnabled(bool enabled);
+    void setLanguages(const QStringList &languages);
+    void setMaxChars(int maxChars);
+
+signals:
+    void textCaptured(const QString &text);
+
+private slots:
+    void clipboardChanged();
+    void selectionChanged();
+    void debounceElapsed();
+
+private:
+    bool accepts(const QString &text) const;
+    static bool looksLikeCode(const QString &text);
+
+    LanguageIdentifier *languageIdentifier;
+    QTimer *debounceTimer;
+    QClipboard::Mode pendingMode;
+    QStringList languages;
+    int maxChars;
+    bool enabled;
+    QList<size_t> recentHashes;
+};
+
+#endif // CLIPBOARDWATCHER_H
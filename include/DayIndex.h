@@ -0,0 +1,62 @@
+#ifndef DAYINDEX_H
+#define DAYINDEX_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QList>
+#include <QDate>
+#include <QDateTime>
+
+class QFileSystemWatcher;
+class QTimer;
+
+struct DayInfo {
+    QDate date;
+    bool hasLog = false;
+    bool hasReport = false;
+    bool archived = false; // The log only exists in the monthly archives
+    bool reportArchived = false;
+    int entryCount = -1; // Unknown for archived days until day() reads them
+    qint64 bytes = -1;
+    QDateTime logModified;
+    QDateTime reportModified;
+    bool reportUpToDate() const;
+};
+
+// Every day that has a log or a report, with its entry count, size and report state.
+// Built from one directory listing on first use, then kept current by the write hooks in
+// AppDataManager and by watching the folders for changes made by anything else.
+class DayIndex : public QObject {
+    Q_OBJECT
+public:
+    DayIndex(const QString &directoryPath, const QString &archivePath, QObject *parent = nullptr);
+    QList<DayInfo> recentDays(int maxDays);
+    QList<DayInfo> daysBetween(const QDate &from, const QDate &to);
+    DayInfo day(const QDate &date);
+    QDate firstDay();
+    void recordEntry(const QDate &date, qint64 bytes);
+    void recordReport(const QDate &date);
+    void unload();
+
+signals:
+    void changed();
+
+private:
+    void ensureLoaded();
+    void scanDirectory();
+    void scanArchive();
+    void watch();
+
+    QString directoryPath;
+    QString archivePath;
+    bool loaded;
+    bool archiveChanged;
+    QStringList dayFileNames; // As of the last scan, to ignore changes to other files
+    QMap<QDate, DayInfo> days;
+    QFileSystemWatcher *watcher;
+    QTimer *rescanTimer;
+};
+
+#endif // DAYINDEX_H
@@ -0,0 +1,35 @@
+#ifndef DAYPICKERDIALOG_H
+#define DAYPICKERDIALOG_H
+
+#include <QDialog>
+#include <QCalendarWidget>
+#include <QLabel>
+#include <QPushButton>
+
+#include "DayIndex.h"
+
+// Picks any logged day for a report. Days are marked one month at a time, as the
+// calendar pages through them, so the dialog opens equally fast after years of logs.
+class DayPickerDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit DayPickerDialog(DayIndex *dayIndex, QWidget *parent = nullptr);
+
+signals:
+    void reportRequested(const QString &dateString);
+
+private slots:
+    void markMonth();
+    void showSelectedDay();
+    void requestReport();
+
+private:
+    DayIndex *dayIndex;
+    QCalendarWidget *calendar;
+    QLabel *infoLabel;
+    QPushButton *reportButton;
+};
+
+#endif // DAYPICKERDIALOG_H
@@ -0,0 +1,38 @@
+#ifndef EXCHANGERECORDER_H
+#define EXCHANGERECORDER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+
+struct RecordedChunk {
+    qint64 atMs; // Since the request was posted
+    QByteArray data;
+};
+
+// Captures API exchanges into fixture files or feeds them back instead of the network.
+// Fixtures are keyed by a hash of the request body and never contain the API key.
+// The mode is chosen once at startup, before any request is sent.
+class ExchangeRecorder {
+public:
+    static void startRecording(const QString &directory);
+    static void startReplay(const QString &directory, double speed);
+    // Answers every request with a made-up but well-formed reply after latencyMs
+    static void startStub(int latencyMs);
+    static bool isRecording();
+    // True when requests never reach the network (replay or stub)
+    static bool isOffline();
+
+    // Must only be called from the network thread
+    static QNetworkReply *post(const QNetworkRequest &request, const QByteArray &body);
+    static void save(const QNetworkRequest &request, const QByteArray &body, QNetworkReply *reply,
+                     const QList<RecordedChunk> &chunks);
+
+private:
+    static QString fixturePath(const QByteArray &body);
+    static QList<RecordedChunk> stubResponse(const QByteArray &body);
+};
+
+#endif // EXCHANGERECORDER_H
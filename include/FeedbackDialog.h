@@ -7,6 +7,9 @@
 #include <QPushButton>
 #include <QScrollArea>
 #include <QLabel>
+#include <QList>
+
+#include "FeedbackSession.h"
 
 class FeedbackDialog : public QDialog
 {
@@ -14,9 +17,11 @@ class FeedbackDialog : public QDialog
 
 public:
     explicit FeedbackDialog(const QString &feedback, QWidget *parent = nullptr);
+    explicit FeedbackDialog(const QList<SentenceFeedback> &feedback, QWidget *parent = nullptr);
 
 private:
     void setupUI();
+    void setupWindow();
     void setupScrollableArea(const QString &feedback);
     
     QVBoxLayout *mainLayout;
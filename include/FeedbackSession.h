@@ -0,0 +1,34 @@
+#ifndef FEEDBACKSESSION_H
+#define FEEDBACKSESSION_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+
+struct SentenceFeedback {
+    QString sentence;
+    QString feedback;
+    bool reused; // Carried over from the previous submission
+};
+
+// Remembers the last submission's per-sentence feedback, so that a resubmitted text only
+// needs feedback for the sentences that were added or changed since then.
+class FeedbackSession : public QObject {
+    Q_OBJECT
+public:
+    explicit FeedbackSession(QObject *parent = nullptr);
+    // Feedback is only reused while the model, prompt and language stay the same
+    void setContext(const QString &context);
+    // Splits the text and returns the distinct sentences that have no feedback yet
+    QStringList changedSentences(const QString &inputText);
+    QList<SentenceFeedback> merge(const QStringList &requested, const QStringList &feedback);
+
+private:
+    QString context;
+    QStringList currentSentences;
+    QHash<QString, QString> feedbackBySentence;
+};
+
+#endif // FEEDBACKSESSION_H
@@ -0,0 +1,43 @@
+#ifndef IDLEBENCHMARK_H
+#define IDLEBENCHMARK_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QTimer>
+#include <functional>
+
+class MainWindow;
+
+// Translates once, hides the window and compares resident memory and GUI thread wakeups
+// while merely hidden and after entering idle mode, then times bringing the window back.
+class IdleBenchmark : public QObject {
+    Q_OBJECT
+public:
+    IdleBenchmark(MainWindow *window, int seconds, QObject *parent = nullptr);
+    void start();
+
+signals:
+    void finished(bool ok);
+
+private slots:
+    void waitForTranslation();
+    void countWakeup();
+
+private:
+    struct Phase {
+        QString name;
+        qint64 rssKb;
+        double wakeupsPerSecond;
+    };
+    void measure(const QString &name, std::function<void()> then);
+    void restore();
+
+    MainWindow *window;
+    int seconds;
+    QTimer *pollTimer;
+    int wakeups;
+    QList<Phase> phases;
+};
+
+#endif // IDLEBENCHMARK_H
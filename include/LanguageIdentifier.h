@@ -0,0 +1,38 @@
+#ifndef LANGUAGEIDENTIFIER_H
+#define LANGUAGEIDENTIFIER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+
+// Guesses the language of a text from hashed character bigram and trigram frequencies.
+// Profiles start from a few built-in sentences per language and grow with every
+// translation, which also covers languages that have no built-in sentences.
+class LanguageIdentifier : public QObject {
+    Q_OBJECT
+public:
+    explicit LanguageIdentifier(QObject *parent = nullptr);
+    bool hasProfile(const QString &language) const;
+    void learn(const QString &language, const QString &text);
+    double score(const QString &language, const QString &text) const;
+    // The clearly best matching candidate, or an empty string when the text is too short or ambiguous
+    QString identify(const QString &text, const QStringList &candidates) const;
+    QStringList languages() const;
+    static QString runBenchmark();
+
+private:
+    struct Profile {
+        QVector<float> counts;
+        double norm = 0.0;
+        double total = 0.0;
+    };
+    static QVector<float> features(const QString &text, int *letterCount = nullptr);
+    void addText(const QString &language, const QString &text, float weight);
+    QString bestOf(const QString &text, const QStringList &candidates, double *margin, int *letterCount) const;
+
+    QHash<QString, Profile> profiles; // Keyed by lowercased language name
+};
+
+#endif // LANGUAGEIDENTIFIER_H
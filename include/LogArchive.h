@@ -0,0 +1,35 @@
+#ifndef LOGARCHIVE_H
+#define LOGARCHIVE_H
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QByteArray>
+#include <QDate>
+
+// Monthly archives of old day logs and reports. Each archive starts with an index of
+// its members, so a single day can be read by seeking straight to its compressed bytes.
+class LogArchive {
+public:
+    explicit LogArchive(const QString &directoryPath);
+    bool contains(const QString &memberName) const;
+    QByteArray readMember(const QString &memberName) const;
+    QStringList memberNames(const QString &month) const;
+    QStringList months() const;
+    bool archiveFiles(const QString &month, const QStringList &filePaths);
+    static QString monthForMember(const QString &memberName);
+
+private:
+    struct IndexEntry {
+        QString name;
+        qint64 offset;
+        qint64 size;
+    };
+    QString archivePath(const QString &month) const;
+    QList<IndexEntry> readIndex(const QString &month) const;
+    QMap<QString, QByteArray> readCompressedMembers(const QString &month) const;
+
+    QString directoryPath;
+};
+
+#endif // LOGARCHIVE_H
@@ -0,0 +1,63 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QString>
+#include <QMutex>
+#include <atomic>
+#include <array>
+
+// Process-wide counters and histograms. Recording only touches atomics, so it is cheap
+// enough for the request hot path and safe from the network thread.
+class Metrics {
+public:
+    enum Task { TaskTranslation, TaskReport, TaskFeedback, TaskCount };
+    enum ErrorClass { ErrorNetwork, ErrorTimeout, ErrorRateLimit, ErrorClient, ErrorServer, ErrorParse, ErrorClassCount };
+    enum HistogramId { HistogramRequestLatency, HistogramFirstByte, HistogramCount };
+
+    static Metrics &instance();
+    static QString taskName(Task task);
+    static QString errorClassName(ErrorClass errorClass);
+
+    void recordRequest(Task task, const QString &model);
+    void recordError(Task task, ErrorClass errorClass);
+    void recordTokens(Task task, qint64 promptTokens, qint64 completionTokens, qint64 cachedPromptTokens);
+    void recordLatency(Task task, HistogramId histogram, qint64 elapsedMs);
+    void recordLogWrite(qint64 elapsedMs);
+    void recordMemoryLookups(int lookups, int hits);
+
+    QString toPrometheus() const;
+    QByteArray toJson() const;
+
+private:
+    static const int MAX_MODELS = 16;
+    static const int BUCKET_COUNT = 10;
+    static const std::array<qint64, BUCKET_COUNT> BUCKET_BOUNDS_MS;
+
+    struct Histogram {
+        std::array<std::atomic<quint64>, BUCKET_COUNT + 1> buckets{};
+        std::atomic<quint64> count{0};
+        std::atomic<quint64> sumMs{0};
+        void record(qint64 elapsedMs);
+    };
+    struct ModelSlot {
+        std::atomic<bool> used{false};
+        QString name;
+        std::array<std::atomic<quint64>, TaskCount> requests{};
+    };
+
+    Metrics() = default;
+    int modelSlot(const QString &model);
+
+    std::array<ModelSlot, MAX_MODELS + 1> models; // the last slot collects overflow
+    QMutex modelRegistration;
+    std::array<std::array<std::atomic<quint64>, ErrorClassCount>, TaskCount> errors{};
+    std::array<std::atomic<quint64>, TaskCount> promptTokens{};
+    std::array<std::atomic<quint64>, TaskCount> completionTokens{};
+    std::array<std::atomic<quint64>, TaskCount> cachedPromptTokens{};
+    std::array<std::array<Histogram, HistogramCount>, TaskCount> histograms;
+    Histogram logWrites;
+    std::atomic<quint64> memoryLookups{0};
+    std::atomic<quint64> memoryHits{0};
+};
+
+#endif // METRICS_H
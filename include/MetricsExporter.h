@@ -0,0 +1,28 @@
+#ifndef METRICSEXPORTER_H
+#define METRICSEXPORTER_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QTcpServer>
+
+// Publishes Metrics as Prometheus text and JSON, both to files refreshed on a timer and,
+// when a port is given, over HTTP on localhost (GET /metrics or /metrics.json).
+class MetricsExporter : public QObject {
+    Q_OBJECT
+public:
+    explicit MetricsExporter(const QString &directoryPath, QObject *parent = nullptr);
+    bool start(quint16 port);
+    void stop();
+
+private slots:
+    void writeFiles();
+    void handleConnection();
+
+private:
+    QString directoryPath;
+    QTimer writeTimer;
+    QTcpServer server;
+};
+
+#endif // METRICSEXPORTER_H
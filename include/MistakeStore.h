@@ -0,0 +1,52 @@
+#ifndef MISTAKESTORE_H
+#define MISTAKESTORE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <QPair>
+#include <QDate>
+#include <QJsonArray>
+
+struct MistakeRecord {
+    QString original;
+    QString corrected;
+    QString explanation;
+    QString category;
+};
+
+// Column-oriented store of every mistake found by the daily reports. The day and category
+// columns live in their own small file so that aggregate queries never touch the texts.
+class MistakeStore : public QObject {
+    Q_OBJECT
+public:
+    explicit MistakeStore(const QString &directoryPath, QObject *parent = nullptr);
+    void replaceDay(const QDate &date, const QList<MistakeRecord> &records);
+    QList<QPair<QString, int>> topCategories(const QDate &from, const QDate &to, int limit = 10);
+    QList<MistakeRecord> recordsForCategory(const QString &category, const QDate &from, const QDate &to);
+    int rowCount();
+    static QList<MistakeRecord> recordsFromJson(const QJsonArray &mistakes);
+
+private:
+    void ensureLoaded();
+    void ensureTextsLoaded();
+    bool save();
+    quint16 categoryId(const QString &category);
+    int lowerBound(qint32 dayNumber) const;
+
+    QString columnsPath;
+    QString textsPath;
+    bool loaded;
+    bool textsLoaded;
+    // Rows are kept sorted by day so date ranges are found with a binary search
+    QVector<qint32> dayColumn;
+    QVector<quint16> categoryColumn;
+    QStringList categoryDictionary;
+    QStringList originalColumn;
+    QStringList correctedColumn;
+    QStringList explanationColumn;
+};
+
+#endif // MISTAKESTORE_H
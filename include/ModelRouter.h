@@ -0,0 +1,38 @@
+#ifndef MODELROUTER_H
+#define MODELROUTER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QDateTime>
+
+class ModelStats;
+
+// Picks a translation model per request from a tier list such as "gpt-4o-mini:400, gpt-4.1".
+// Each tier handles inputs up to its token limit; the last tier has no limit.
+class ModelRouter : public QObject {
+    Q_OBJECT
+public:
+    explicit ModelRouter(ModelStats *stats, QObject *parent = nullptr);
+    void setTiers(const QString &tierSpec);
+    void setLatencyBudgetMs(int budgetMs);
+    bool hasTiers() const;
+    QString route(const QString &inputText);
+    bool isDemoted(const QString &model) const;
+    static int estimateTokens(const QString &text);
+
+private:
+    struct Tier {
+        QString model;
+        int maxTokens; // -1 means unbounded
+    };
+    bool checkHealth(const QString &model);
+
+    ModelStats *modelStats;
+    QList<Tier> tiers;
+    int latencyBudgetMs;
+    QHash<QString, QDateTime> demotedUntil;
+};
+
+#endif // MODELROUTER_H
@@ -0,0 +1,43 @@
+#ifndef MODELSTATS_H
+#define MODELSTATS_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QVector>
+
+// Keeps per-model latency samples and hedging counters for the lifetime of the app.
+class ModelStats : public QObject {
+    Q_OBJECT
+public:
+    explicit ModelStats(QObject *parent = nullptr);
+    void recordRequest(const QString &model);
+    void recordFirstByte(const QString &model, qint64 elapsedMs);
+    void recordCompletion(const QString &model, qint64 elapsedMs, bool success);
+    double latencyEstimate(const QString &model) const;
+    double errorRate(const QString &model) const;
+    int completionCount(const QString &model) const;
+    qint64 firstBytePercentile(const QString &model, double percentile) const;
+    qint64 hedgeDelay(const QString &model) const;
+    bool canHedge(const QString &model) const;
+    void recordHedgeIssued(const QString &model);
+    void recordHedgeWon(const QString &model);
+    int requestCount(const QString &model) const;
+    int hedgesIssued(const QString &model) const;
+    int hedgesWon(const QString &model) const;
+
+private:
+    struct Entry {
+        QVector<qint64> firstByteSamples;
+        int nextSample = 0;
+        int requests = 0;
+        int hedgesIssued = 0;
+        int hedgesWon = 0;
+        int completions = 0;
+        double latencyEwma = 0.0;
+        double errorEwma = 0.0;
+    };
+    QHash<QString, Entry> entries;
+};
+
+#endif // MODELSTATS_H
@@ -0,0 +1,19 @@
+#ifndef NETWORKTHREAD_H
+#define NETWORKTHREAD_H
+
+#include <QThread>
+#include <QNetworkAccessManager>
+
+// The single worker thread that performs all API requests, so that building, sending and
+// parsing requests never competes with the GUI thread.
+class NetworkThread {
+public:
+    static QThread *thread();
+    // Must only be called from the network thread itself
+    static QNetworkAccessManager *networkManager();
+    // Closes kept-alive connections and returns freed heap to the system, for when the app goes idle
+    static void releaseIdleResources();
+    static void shutdown();
+};
+
+#endif // NETWORKTHREAD_H
@@ -3,34 +3,69 @@
 
 #include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QJsonObject>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
 
+#include "RequestWorker.h"
+#include "RequestScheduler.h"
+
+class ModelStats;
+
+// GUI-side handle for one API request. The request itself runs on the network thread
+// and its results come back through the signals below.
 class OpenAICommunicator : public QObject {
     Q_OBJECT
 public:
     explicit OpenAICommunicator(const QString &apiKey, QObject *parent = nullptr);
+    ~OpenAICommunicator();
     void setModelName(const QString &modelName);
     void setPrompt(const QString &sourceLang, const QString &targetLang, const QString &inputText);
     void setPromptWithTemplate(const QString &promptTemplate, const QString &sourceLang, const QString &targetLang, const QString &inputText);
     void setPromptRaw(const QString &prompt);
+    // Varying instructions that must not become part of the cacheable prompt prefix
+    void setContext(const QString &context);
+    void setInputText(const QString &inputText);
+    void setSegments(const QStringList &segments);
+    void setResponseFormat(ResponseFormat format);
+    void setTask(Metrics::Task task);
+    // Defaults to the class matching the task
+    void setPriority(RequestScheduler::Priority priority);
+    void setModelStats(ModelStats *stats);
+    void setHedgingEnabled(bool enabled);
     void sendRequest();
+    // Where every request is sent, e.g. a local OpenAI-compatible server
+    static void setDefaultBaseUrl(const QString &baseUrl);
+    static QString defaultBaseUrl();
     QString getPrompt() const;
 
 signals:
     void replyReceived(const QString &translation);
+    void segmentsReceived(const QStringList &translations);
+    void structuredReplyReceived(const QJsonObject &result);
     void errorOccurred(const QString &errorString);
+    // Tells the worker on the network thread that nobody waits for its result anymore
+    void abortRequested();
 
 private slots:
-    void handleNetworkReply(QNetworkReply *reply);
+    void handleFirstByte(qint64 elapsedMs);
+    void handleHedgeIssued();
+    void handleCompleted(qint64 elapsedMs, bool success, bool hedgeWon);
+    void handleUsage(qint64 promptTokens, qint64 completionTokens, qint64 cachedTokens);
 
 private:
+    QString effectiveModelName() const;
+
     QString apiKey;
     QString modelName;
     QString prompt;
+    QString context;
     QString inputText;
-    QNetworkAccessManager networkManager;
+    QStringList segments;
+    ResponseFormat responseFormat;
+    Metrics::Task task;
+    int priority; // -1 until set explicitly
+    ModelStats *modelStats;
+    bool hedgingEnabled;
 };
 
-#endif // OPENAICOMMUNICATOR_H 
\ No newline at end of file
+#endif // OPENAICOMMUNICATOR_H
@@ -0,0 +1,41 @@
+#ifndef REPLAYREPLY_H
+#define REPLAYREPLY_H
+
+#include "ExchangeRecorder.h"
+
+#include <QNetworkReply>
+#include <QElapsedTimer>
+
+// A network reply that plays back a recorded exchange, chunk by chunk, with the recorded
+// timing divided by the replay speed (a speed of 0 delivers everything immediately).
+class ReplayReply : public QNetworkReply {
+    Q_OBJECT
+public:
+    ReplayReply(const QNetworkRequest &request, int statusCode, QNetworkReply::NetworkError errorCode,
+                const QString &errorString, const QList<RecordedChunk> &chunks, double speed,
+                QObject *parent = nullptr);
+
+    void abort() override;
+    qint64 bytesAvailable() const override;
+    bool isSequential() const override;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+
+private slots:
+    void deliverNext();
+
+private:
+    void finish(QNetworkReply::NetworkError code, const QString &message);
+
+    QList<RecordedChunk> chunks;
+    int nextChunk;
+    QByteArray buffer;
+    qint64 readOffset;
+    QNetworkReply::NetworkError recordedError;
+    QString recordedErrorString;
+    double speed;
+    QElapsedTimer clock;
+};
+
+#endif // REPLAYREPLY_H
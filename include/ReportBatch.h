@@ -0,0 +1,55 @@
+#ifndef REPORTBATCH_H
+#define REPORTBATCH_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+
+class AppDataManager;
+class SettingsManager;
+
+// Backfills reports for many days through one batch job: uploads the requests as a JSONL
+// file, polls the batch until it is done and writes each day's report from the results.
+// The batch id is kept in the settings, so polling resumes after a restart.
+class ReportBatch : public QObject {
+    Q_OBJECT
+public:
+    ReportBatch(AppDataManager *appDataManager, SettingsManager *settingsManager, QObject *parent = nullptr);
+    void setApiKey(const QString &apiKey);
+    bool isRunning() const;
+    // Whether the running batch includes this day
+    bool isPending(const QString &dateString) const;
+    void submit(const QStringList &dateStrings);
+
+signals:
+    void submitted(int requestCount);
+    void reportReady(const QString &dateString);
+    void finished(int written, int failed);
+    void errorOccurred(const QString &errorString);
+
+private slots:
+    void poll();
+
+private:
+    QNetworkRequest apiRequest(const QString &path) const;
+    QByteArray buildInputFile(const QStringList &dateStrings, int *requestCount) const;
+    void createBatch(const QString &inputFileId);
+    void downloadResults(const QString &outputFileId, int failedCount);
+    int writeResults(const QByteArray &jsonl);
+    void setBatchId(const QString &batchId);
+    void fail(const QString &errorString);
+
+    AppDataManager *appDataManager;
+    SettingsManager *settingsManager;
+    QNetworkAccessManager *networkManager;
+    QTimer *pollTimer;
+    QString apiKey;
+    QString batchId;
+    QStringList batchDays;
+    bool busy;
+};
+
+#endif // REPORTBATCH_H
@@ -0,0 +1,52 @@
+#ifndef REPORTSCHEDULER_H
+#define REPORTSCHEDULER_H
+
+#include <QObject>
+#include <QString>
+#include <QSet>
+#include <QDate>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class AppDataManager;
+class SettingsManager;
+class ReportBatch;
+
+// Generates reports for finished days in the background, while the user is away or once
+// the configured time of day has passed, so that opening them later is instant.
+class ReportScheduler : public QObject {
+    Q_OBJECT
+public:
+    ReportScheduler(AppDataManager *appDataManager, SettingsManager *settingsManager, QObject *parent = nullptr);
+    void setApiKey(const QString &apiKey);
+    void setEnabled(bool enabled);
+    // Days in this batch are left alone, so the same report isn't paid for twice
+    void setReportBatch(ReportBatch *reportBatch);
+    bool isPending(const QString &dateString) const;
+
+signals:
+    void reportReady(const QString &dateString);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void tick();
+
+private:
+    bool shouldRun();
+    QStringList daysWithoutReport() const;
+    void generate(const QString &dateString, const QString &fileContent, int estimatedTokens);
+
+    AppDataManager *appDataManager;
+    SettingsManager *settingsManager;
+    ReportBatch *reportBatch;
+    QString apiKey;
+    QTimer *timer;
+    QElapsedTimer sinceLastInput;
+    QSet<QString> inFlight;
+    QSet<QString> failedDays;
+    QDate lastScheduledRun;
+};
+
+#endif // REPORTSCHEDULER_H
@@ -0,0 +1,46 @@
+#ifndef REQUESTSCHEDULER_H
+#define REQUESTSCHEDULER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QQueue>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <array>
+#include <functional>
+
+// Decides when each API request may start. Interactive translations always start right
+// away; feedback, reports and background work wait for a free slot in their class, and
+// reports and background work also hold back while a translation is in flight.
+class RequestScheduler : public QObject {
+    Q_OBJECT
+public:
+    enum Priority { PriorityInteractive, PriorityFeedback, PriorityReport, PriorityBackground, PriorityCount };
+
+    static RequestScheduler &instance();
+    // create() must return the request, not yet started, as an object with a start() slot
+    // whose destruction marks the end of the request. The scheduler starts it with a queued
+    // call. create() is not called if the owner has been deleted in the meantime.
+    void submit(Priority priority, QObject *owner, const std::function<QObject*()> &create);
+    int queuedCount(Priority priority) const;
+    int runningCount(Priority priority) const;
+
+private slots:
+    void dispatch();
+
+private:
+    explicit RequestScheduler(QObject *parent = nullptr);
+    bool canStart(int priority, bool starving) const;
+    void release(int priority);
+
+    struct Pending {
+        QPointer<QObject> owner;
+        std::function<QObject*()> create;
+        QElapsedTimer waiting;
+    };
+    std::array<QQueue<Pending>, PriorityCount> queues;
+    std::array<int, PriorityCount> running{};
+    QTimer *agingTimer;
+};
+
+#endif // REQUESTSCHEDULER_H
@@ -0,0 +1,96 @@
+#ifndef REQUESTWORKER_H
+#define REQUESTWORKER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QList>
+#include <QHash>
+
+#include "Metrics.h"
+#include "ExchangeRecorder.h"
+
+// The JSON schema the model has to answer with, one per kind of task
+enum class ResponseFormat {
+    Translation,
+    SegmentedTranslation,
+    MistakeReport,
+    SentenceFeedback
+};
+
+// Everything a request needs, copied so the worker never touches GUI-thread state
+struct RequestSpec {
+    QString apiKey;
+    QString modelName;
+    QString prompt; // Kept byte-identical across calls, so it forms a cacheable prefix
+    QString context; // Per-request instructions, sent after the prefix
+    QString inputText;
+    QStringList segments;
+    ResponseFormat responseFormat = ResponseFormat::Translation;
+    Metrics::Task task = Metrics::TaskTranslation;
+    qint64 hedgeDelayMs = -1; // -1 disables hedging
+    QString baseUrl = "https://api.openai.com/v1";
+    bool stream = false; // Needed to measure the time to the first token
+};
+
+// Runs one chat completion on the network thread, including the optional hedge request,
+// and deletes itself once the result has been delivered.
+class RequestWorker : public QObject {
+    Q_OBJECT
+public:
+    explicit RequestWorker(const RequestSpec &spec, QObject *parent = nullptr);
+    // The chat completion body for spec, also used for batch job lines
+    static QJsonObject requestJson(const RequestSpec &spec);
+
+public slots:
+    void start();
+    // Cancels the request and any hedge; nothing is emitted afterwards
+    void abort();
+
+signals:
+    void replyReceived(const QString &translation);
+    void segmentsReceived(const QStringList &translations);
+    void structuredReplyReceived(const QJsonObject &result);
+    void errorOccurred(const QString &errorString);
+    void firstByteReceived(qint64 elapsedMs);
+    void firstTokenReceived(qint64 elapsedMs);
+    void usageReceived(qint64 promptTokens, qint64 completionTokens, qint64 cachedTokens, int contentChars);
+    void hedgeIssued();
+    void completed(qint64 elapsedMs, bool success, bool hedgeWon);
+
+private slots:
+    void handleReadyRead();
+    void handleFinished();
+    void sendHedgeRequest();
+
+private:
+    QByteArray buildBody() const;
+    static QJsonObject responseSchema(ResponseFormat responseFormat);
+    void postRequest(bool isHedge);
+    void parseResponse(const QJsonObject &root);
+    static QJsonObject streamedResponse(const QByteArray &data);
+    void fail(Metrics::ErrorClass errorClass, const QString &errorString);
+
+    RequestSpec spec;
+    QNetworkRequest request;
+    QByteArray body;
+    QList<QNetworkReply*> activeReplies;
+    // Response bytes read so far, and their arrival times when recording
+    struct ReplyData {
+        QByteArray data;
+        QList<RecordedChunk> chunks;
+    };
+    QHash<QNetworkReply*, ReplyData> replyData;
+    QElapsedTimer requestTimer;
+    QTimer *hedgeTimer;
+    bool firstByteSeen;
+    bool firstTokenSeen;
+    bool done;
+};
+
+#endif // REQUESTWORKER_H
@@ -0,0 +1,34 @@
+#ifndef SEARCHDIALOG_H
+#define SEARCHDIALOG_H
+
+#include <QDialog>
+#include <QLineEdit>
+#include <QLabel>
+#include <QTextBrowser>
+#include <QPlainTextEdit>
+#include <QList>
+
+#include "SearchIndex.h"
+
+// Searches all logged inputs and reports as you type; clicking a hit shows the whole entry.
+class SearchDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit SearchDialog(SearchIndex *searchIndex, QWidget *parent = nullptr);
+
+private slots:
+    void runSearch();
+    void showHit(const QUrl &url);
+
+private:
+    SearchIndex *searchIndex;
+    QLineEdit *queryEdit;
+    QLabel *statusLabel;
+    QTextBrowser *resultsView;
+    QPlainTextEdit *entryView;
+    QList<SearchHit> hits;
+};
+
+#endif // SEARCHDIALOG_H
@@ -0,0 +1,88 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QDate>
+#include <QFutureWatcher>
+
+struct SearchHit {
+    QDate date;
+    QString time; // Empty for reports
+    bool isReport;
+    QString text;
+    QString snippet; // HTML, with the matched words in bold
+    double score;
+};
+
+// Full-text index over every logged input and report. Documents are appended to a journal
+// as they are written; the inverted index is built from it on a worker thread when first
+// needed and then kept up to date in memory. Old logs and archives are indexed once, when
+// no journal exists, and the journal is compacted once replaced reports pile up in it.
+class SearchIndex : public QObject {
+    Q_OBJECT
+public:
+    SearchIndex(const QString &directoryPath, const QString &archivePath, QObject *parent = nullptr);
+    void addLogEntry(const QDate &date, const QString &time, const QString &text);
+    void setReport(const QDate &date, const QString &text);
+    // Starts building the index in the background; indexLoaded() follows
+    void load();
+    bool isLoaded() const;
+    // Empty until the index is loaded
+    QList<SearchHit> search(const QString &query, int maxHits = 50);
+    int documentCount() const;
+    void unload();
+    static QStringList tokenize(const QString &text);
+
+signals:
+    void indexLoaded();
+
+private:
+    struct Document {
+        qint32 day;
+        QString time;
+        bool isReport;
+        bool removed;
+        int length;
+        QString text;
+    };
+    struct Posting {
+        int document;
+        int frequency;
+    };
+    // Everything a search needs, built on a worker thread and then handed over
+    struct Index {
+        QVector<Document> documents;
+        QHash<QString, QVector<Posting>> postings;
+        QStringList sortedTerms; // For prefix matching of the word being typed
+        QHash<qint32, int> reportByDay;
+        qint64 totalLength = 0;
+        int removedCount = 0;
+        bool readFromLogs = false; // Rebuilt from the day files rather than the journal
+        void add(const Document &document, bool keepTermsSorted = true);
+        bool containsEntry(const Document &document) const;
+    };
+    enum State { Unloaded, Loading, Loaded };
+
+    static Index loadIndex(const QString &journalPath, const QString &directoryPath, const QString &archivePath);
+    static void indexLogs(Index &index, const QString &directoryPath, const QString &archivePath);
+    static void writeJournal(const QString &journalPath, const Index &index);
+    void indexBuilt();
+    void addDocument(const Document &document);
+    void addToJournal(const Document &document);
+    QStringList expand(const QString &term) const;
+    static QString snippet(const QString &text, const QStringList &terms);
+
+    QString journalPath;
+    QString directoryPath;
+    QString archivePath;
+    State state;
+    Index data;
+    QList<Document> pendingDocuments; // Written while the index was being built
+    QFutureWatcher<Index> *loader;
+};
+
+#endif // SEARCHINDEX_H
@@ -5,6 +5,7 @@
 #include <QString>
 #include <QSettings>
 #include <QStringList>
+#include <QDate>
 
 class SettingsManager : public QObject {
     Q_OBJECT
@@ -12,6 +13,9 @@ public:
     explicit SettingsManager(QObject *parent = nullptr);
     QString translationModelName() const;
     void setTranslationModelName(const QString &name);
+    QString translationModelTiers() const;
+    void setTranslationModelTiers(const QString &tiers);
+    int translationLatencyBudgetMs() const;
     QString reportModelName() const;
     void setReportModelName(const QString &name);
     QString feedbackModelName() const;
@@ -22,6 +26,12 @@ public:
     void setTargetLang(const QString &lang);
     QString lastInputText() const;
     void setLastInputText(const QString &text);
+    bool hedgeTranslations() const;
+    void setHedgeTranslations(bool enabled);
+    int translationParallelism() const;
+    void setTranslationParallelism(int parallelism);
+    bool useTranslationMemory() const;
+    void setUseTranslationMemory(bool enabled);
     QString translationPrompt() const;
     void setTranslationPrompt(const QString &prompt);
     QString reportPrompt() const;
@@ -31,6 +41,34 @@ public:
     QString getDefaultTranslationPrompt() const;
     QString getDefaultReportPrompt() const;
     QString getDefaultFeedbackPrompt() const;
+    int logArchiveAfterDays() const;
+    void setLogArchiveAfterDays(int days);
+    bool stallWatchdogEnabled() const;
+    void setStallWatchdogEnabled(bool enabled);
+    int stallThresholdMs() const;
+    bool metricsExportEnabled() const;
+    void setMetricsExportEnabled(bool enabled);
+    int metricsPort() const;
+    QString apiBaseUrl() const;
+    void setApiBaseUrl(const QString &url);
+    bool detectTranslationDirection() const;
+    void setDetectTranslationDirection(bool enabled);
+    bool watchClipboard() const;
+    void setWatchClipboard(bool enabled);
+    int clipboardWatchMaxChars() const;
+    bool checkSpelling() const;
+    void setCheckSpelling(bool enabled);
+    bool precomputeReports() const;
+    void setPrecomputeReports(bool enabled);
+    QString precomputeReportsTime() const;
+    void setPrecomputeReportsTime(const QString &time);
+    int precomputeReportsTokenBudget() const;
+    int precomputeReportsTokensSpent(const QDate &day) const;
+    void setPrecomputeReportsTokensSpent(const QDate &day, int tokens);
+    QString reportBatchId() const;
+    void setReportBatchId(const QString &batchId);
+    QStringList reportBatchDays() const;
+    void setReportBatchDays(const QStringList &dateStrings);
     QStringList getMessageHistory() const;
     void addMessageToHistory(const QString &message);
     void sync();
@@ -18,6 +18,7 @@ public:
     bool tryToRun();
     void bringExistingInstanceToFront();
     void startListening();
+    void setIdle(bool idle);
 
 signals:
     void bringToFrontRequested();
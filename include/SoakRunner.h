@@ -0,0 +1,44 @@
+#ifndef SOAKRUNNER_H
+#define SOAKRUNNER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QUrl>
+
+class QMainWindow;
+
+// Drives the main window through many translate, feedback, report and history cycles
+// against the stub transport and checks that memory and object counts stay flat.
+class SoakRunner : public QObject {
+    Q_OBJECT
+public:
+    SoakRunner(QMainWindow *window, int cycles, QObject *parent = nullptr);
+    void start();
+    static qint64 residentMemoryKb();
+
+signals:
+    void finished(bool passed);
+
+private slots:
+    void nextStep();
+    void ignoreUrl(const QUrl &url);
+
+private:
+    enum Step { StepTranslate, StepWaitTranslate, StepReport, StepWaitReport, StepHistory };
+    int objectCount() const;
+    bool busy() const;
+    void sample();
+    void finish();
+
+    QMainWindow *window;
+    int cycles;
+    int cycle;
+    Step step;
+    QTimer *stepTimer;
+    qint64 baselineRssKb;
+    int baselineObjects;
+    qint64 peakRssKb;
+    int peakObjects;
+};
+
+#endif // SOAKRUNNER_H
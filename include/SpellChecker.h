@@ -0,0 +1,42 @@
+#ifndef SPELLCHECKER_H
+#define SPELLCHECKER_H
+
+#include <QSyntaxHighlighter>
+#include <QTextCharFormat>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QSharedPointer>
+
+#include "WordTrie.h"
+
+// Underlines words missing from the source language's dictionary as the user types.
+// Dictionaries are word lists or Hunspell .dic files, loaded off the GUI thread.
+class SpellChecker : public QSyntaxHighlighter {
+    Q_OBJECT
+public:
+    explicit SpellChecker(QTextDocument *document);
+    void setLanguage(const QString &languageName);
+    void setEnabled(bool enabled);
+    // Drops the dictionary and cached verdicts; the next setLanguage() loads them again
+    void releaseDictionary();
+    bool isMisspelled(const QString &word);
+    QStringList suggestions(const QString &word) const;
+    static QStringList dictionaryCandidates(const QString &languageName);
+
+protected:
+    void highlightBlock(const QString &text) override;
+
+private slots:
+    void dictionaryLoaded();
+
+private:
+    QSharedPointer<const WordTrie> dictionary;
+    QFutureWatcher<QSharedPointer<const WordTrie>> *loader;
+    QString language;
+    bool enabled;
+    QTextCharFormat misspelledFormat;
+    // Typing re-checks the same words over and over, so verdicts are remembered
+    QHash<QString, bool> verdicts;
+};
+
+#endif // SPELLCHECKER_H
@@ -0,0 +1,44 @@
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include <QThread>
+#include <QString>
+#include <QElapsedTimer>
+#include <atomic>
+
+// Pings the GUI event loop from a background thread and reports every time the loop
+// fails to answer within the threshold, together with the operation that was running.
+class StallWatchdog : public QThread {
+    Q_OBJECT
+public:
+    explicit StallWatchdog(const QString &reportPath, QObject *parent = nullptr);
+    ~StallWatchdog();
+    void setThresholdMs(int thresholdMs);
+    void stop();
+    int stallCount() const;
+
+    // Tags the GUI thread with what it is doing for as long as the object lives
+    class Operation {
+    public:
+        explicit Operation(const char *name);
+        ~Operation();
+    private:
+        bool active;
+        const char *previous;
+    };
+
+protected:
+    void run() override;
+
+private:
+    void recordStall(qint64 startedAtMs, qint64 durationMs, const char *operation);
+
+    QString reportPath;
+    std::atomic<int> thresholdMs;
+    std::atomic<qint64> lastAnsweredPing;
+    std::atomic<int> stalls;
+    QElapsedTimer clock;
+    static std::atomic<const char*> currentOperation;
+};
+
+#endif // STALLWATCHDOG_H
@@ -0,0 +1,22 @@
+#ifndef TEXTSEGMENTER_H
+#define TEXTSEGMENTER_H
+
+#include <QString>
+#include <QList>
+
+// A piece of text together with the whitespace that followed it in the original,
+// so that joining text + separator of every segment gives back the input.
+struct TextSegment {
+    QString text;
+    QString separator;
+};
+
+class TextSegmenter {
+public:
+    static QList<TextSegment> splitSentences(const QString &text);
+    static QList<TextSegment> splitChunks(const QString &text, int maxChunkChars);
+    static QString join(const QList<TextSegment> &segments);
+    static bool isParagraphBreak(const QString &separator);
+};
+
+#endif // TEXTSEGMENTER_H
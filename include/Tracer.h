@@ -0,0 +1,42 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+#include <atomic>
+
+// Collects spans in Chrome trace-event format (viewable in Perfetto or chrome://tracing).
+// While tracing is off a span costs a single relaxed atomic load.
+class Tracer {
+public:
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    static void start();
+    static bool stop(const QString &filePath);
+
+    static void addComplete(const char *name, qint64 startUs, qint64 durationUs);
+    static void asyncBegin(const char *name, quint64 id, const QString &detail = QString());
+    static void asyncEnd(const char *name, quint64 id);
+    static qint64 nowUs();
+
+    class Scope {
+    public:
+        explicit Scope(const char *name_)
+            : name(name_), startUs(Tracer::isEnabled() ? Tracer::nowUs() : -1) {}
+        ~Scope() {
+            if (startUs >= 0) {
+                Tracer::addComplete(name, startUs, Tracer::nowUs() - startUs);
+            }
+        }
+    private:
+        const char *name;
+        qint64 startUs;
+    };
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) Tracer::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+#endif // TRACER_H
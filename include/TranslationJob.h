@@ -0,0 +1,79 @@
+#ifndef TRANSLATIONJOB_H
+#define TRANSLATIONJOB_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+
+#include "TextSegmenter.h"
+#include "RequestScheduler.h"
+
+class OpenAICommunicator;
+class ModelStats;
+class TranslationMemory;
+
+// Translates one input, splitting long texts into chunks that are translated concurrently
+// and put back together in their original order. With a translation memory the input is
+// split into sentences instead, and only sentences the memory cannot fill are sent.
+class TranslationJob : public QObject {
+    Q_OBJECT
+public:
+    explicit TranslationJob(const QString &apiKey, QObject *parent = nullptr);
+    void setModelName(const QString &modelName);
+    void setModelStats(ModelStats *stats);
+    void setHedgingEnabled(bool enabled);
+    void setTranslationMemory(TranslationMemory *memory);
+    // Defaults to interactive, for translations someone is waiting for
+    void setPriority(RequestScheduler::Priority priority);
+    void setPromptTemplate(const QString &promptTemplate, const QString &sourceLang, const QString &targetLang);
+    void start(const QString &inputText);
+    int chunkCount() const;
+    int segmentCount() const;
+    int memoryMatchCount() const;
+    int tokensSaved() const;
+
+signals:
+    void finished(const QString &translation);
+    void failed(const QString &errorString);
+
+private:
+    // Segments that are sent together in one request
+    struct Group {
+        QList<int> segmentIndexes;
+        QString extraPrompt;
+    };
+
+    void planChunks(const QString &inputText);
+    void planWithMemory(const QString &inputText);
+    OpenAICommunicator *createCommunicator();
+    QString contextPrompt(int chunkIndex) const;
+    void launchGroups();
+    void startNextGroup();
+    void groupFinished(const Group &group, const QStringList &translations);
+    void abortAll(const QString &errorString);
+
+    QString apiKey;
+    QString modelName;
+    ModelStats *modelStats;
+    bool hedgingEnabled;
+    TranslationMemory *translationMemory;
+    RequestScheduler::Priority priority;
+    QString promptTemplate;
+    QString sourceLang;
+    QString targetLang;
+    QList<TextSegment> segments;
+    QVector<QString> translatedSegments;
+    QList<Group> groups;
+    QList<OpenAICommunicator*> runningCommunicators;
+    bool segmentMode;
+    int nextGroup;
+    int remainingGroups;
+    int memoryMatches;
+    int savedTokens;
+    bool done;
+    bool launching;
+};
+
+#endif // TRANSLATIONJOB_H
@@ -0,0 +1,55 @@
+#ifndef TRANSLATIONMEMORY_H
+#define TRANSLATIONMEMORY_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QVector>
+#include <QList>
+
+// Local store of previously translated sentences with exact and fuzzy (character trigram) lookup.
+class TranslationMemory : public QObject {
+    Q_OBJECT
+public:
+    struct Match {
+        QString source;
+        QString target;
+        double score;
+    };
+
+    explicit TranslationMemory(const QString &filePath, QObject *parent = nullptr);
+    bool lookupExact(const QString &source, const QString &sourceLang, const QString &targetLang, QString *target);
+    QList<Match> lookupFuzzy(const QString &source, const QString &sourceLang, const QString &targetLang, int maxMatches = 2);
+    void add(const QString &source, const QString &target, const QString &sourceLang, const QString &targetLang);
+    void recordUsage(int segments, int exactMatches, int tokensSaved);
+    int size();
+    // Frees the in-memory index, it is read back from the file on the next lookup
+    void unload();
+    int totalSegments() const;
+    int totalExactMatches() const;
+    int totalTokensSaved() const;
+
+private:
+    struct Entry {
+        QString source;
+        QString target;
+        QString languagePair;
+        int trigramCount;
+    };
+    void ensureLoaded();
+    void insert(const QString &source, const QString &target, const QString &languagePair);
+    static QString normalize(const QString &text);
+    static QString languagePairKey(const QString &sourceLang, const QString &targetLang);
+    static QVector<uint> trigrams(const QString &normalized);
+
+    QString filePath;
+    bool loaded;
+    QVector<Entry> entries;
+    QHash<QString, int> exactIndex;
+    QHash<uint, QVector<int>> trigramIndex;
+    int segmentsSeen;
+    int exactMatchesSeen;
+    int tokensSaved;
+};
+
+#endif // TRANSLATIONMEMORY_H
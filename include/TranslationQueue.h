@@ -0,0 +1,58 @@
+#ifndef TRANSLATIONQUEUE_H
+#define TRANSLATIONQUEUE_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <functional>
+
+class TranslationJob;
+
+// Lets several translations be submitted back to back. Up to a configurable number run at
+// once, and results are delivered strictly in submission order, so a short message sent
+// second never overtakes a long one sent first.
+class TranslationQueue : public QObject {
+    Q_OBJECT
+public:
+    enum Status { Queued, Running, Done, Failed };
+    struct Entry {
+        int id = 0;
+        QString inputText;
+        QString sourceLang;
+        QString targetLang;
+        QString modelName;
+        bool reversed = false;
+        bool quickFeedback = false;
+        Status status = Queued;
+        QString translation;
+        QString errorString;
+    };
+    // Creates the configured, not yet started job for an entry
+    using JobFactory = std::function<TranslationJob*(const Entry &entry)>;
+
+    explicit TranslationQueue(JobFactory jobFactory, QObject *parent = nullptr);
+    void setParallelism(int parallelism);
+    int submit(const Entry &entry);
+    bool isBusy() const;
+    bool isPending(const QString &inputText) const;
+    int pendingCount() const;
+
+signals:
+    void statusChanged(const TranslationQueue::Entry &entry);
+    void delivered(const TranslationQueue::Entry &entry);
+
+private:
+    void startNext();
+    void finish(int id, Status status, const QString &result);
+    void deliverReady();
+    Entry *find(int id);
+
+    JobFactory jobFactory;
+    QList<Entry> entries; // Submission order, until delivered
+    int parallelism;
+    int running;
+    int nextId;
+    bool delivering;
+};
+
+#endif // TRANSLATIONQUEUE_H
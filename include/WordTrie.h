@@ -0,0 +1,43 @@
+#ifndef WORDTRIE_H
+#define WORDTRIE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QPair>
+
+// A read-only dictionary trie stored as two flat arrays. The children of each node are
+// contiguous and sorted, so lookups walk the word with a binary search per character.
+class WordTrie {
+public:
+    WordTrie();
+    // Words are lowercased and deduplicated while building
+    static WordTrie build(QStringList wordList);
+    static QStringList loadWordList(const QString &filePath);
+    bool contains(const QString &word) const;
+    // Dictionary words within maxDistance edits of the word, closest first
+    QStringList suggestions(const QString &word, int maxDistance = 2, int maxResults = 5) const;
+    int wordCount() const;
+    bool isEmpty() const;
+
+private:
+    struct Node {
+        int firstEdge;
+        int edgeCount;
+        bool terminal;
+    };
+    struct Edge {
+        QChar ch;
+        int child;
+    };
+    int buildNode(const QStringList &words, int begin, int end, int depth);
+    int findChild(int node, QChar ch) const;
+    void collectSuggestions(int node, QChar ch, const QString &word, const QVector<int> &previousRow,
+                            QString &prefix, int maxDistance, QList<QPair<int, QString>> &found) const;
+
+    QVector<Node> nodes;
+    QVector<Edge> edges;
+    int words;
+};
+
+#endif // WORDTRIE_H
@@ -8,6 +8,10 @@
 #include "ApiKeyDialog.h"
 #include "PromptEditDialog.h"
 #include "FeedbackDialog.h"
+#include "ModelStats.h"
+#include "ModelRouter.h"
+#include "TranslationMemory.h"
+#include "TranslationQueue.h"
 
 #include <QMainWindow>
 #include <QtNetwork/QNetworkAccessManager>
@@ -24,6 +28,9 @@
 #include <QUrl>
 #include <QDate>
 #include <QLocale>
+#include <QSystemTrayIcon>
+#include <QTimer>
+#include <QHash>
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -34,36 +41,104 @@ QT_END_NAMESPACE
 class OpenAICommunicator;
 class AppDataManager;
 class SettingsManager;
+class StallWatchdog;
+class MetricsExporter;
+class ReportScheduler;
+class ReportBatch;
+class ClipboardWatcher;
+class FeedbackSession;
+class SpellChecker;
+class LanguageIdentifier;
+class TranslationJob;
+class QListWidgetItem;
 
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
+    Q_PROPERTY(bool busy READ isBusy)
 
 public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
+    bool isIdle() const;
+    // Translations are queued or feedback is on its way
+    bool isBusy() const;
+
+public slots:
+    void enterIdleMode();
+
+signals:
+    void idleChanged(bool idle);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
 
 private slots:
     void on_goButton_clicked();
     void actionReset_OpenAI_API_key();
     void actionOpenCorrectionsFolder();
     void actionGenerateMistakesReport();
+    void actionBatchGenerateReports();
+    void actionEditLogArchiveAge();
+    void actionTopMistakeCategories();
+    void actionSearch();
+    void actionPrecomputeReportsToggled(bool checked);
+    void actionEditPrecomputeReportsTime();
     void actionHelp();
     void actionQuit();
     void actionEditTranslationModel();
+    void actionEditTranslationModelTiers();
     void actionEditReportsModel();
     void actionEditFeedbackModel();
+    void actionEditApiBaseUrl();
     void actionEditTranslationPrompt();
     void actionEditReportPrompt();
     void actionEditFeedbackPrompt();
+    void actionHedgeTranslationsToggled(bool checked);
+    void actionEditTranslationParallelism();
+    void actionUseTranslationMemoryToggled(bool checked);
+    void actionCheckSpellingToggled(bool checked);
+    void actionDetectTranslationDirectionToggled(bool checked);
+    void actionWatchClipboardToggled(bool checked);
+    void showInputContextMenu(const QPoint &position);
+    void actionDetectUiStallsToggled(bool checked);
+    void actionOpenStallReport();
+    void actionExportMetricsToggled(bool checked);
+    void actionRecordTraceToggled(bool checked);
     void onHistoryActionTriggered();
     void onGenerateReportActionTriggered();
+    void setupGenerateReportMenu();
+    void pickReportDay();
+    void translationDelivered(const TranslationQueue::Entry &entry);
+    void queueItemClicked(QListWidgetItem *item);
+    void hideWhenDone();
 
 private:
     Ui::MainWindow *ui;
     KeyChainClass *keychain;
     AppDataManager *appDataManager;
     SettingsManager *settingsManager;
+    ModelStats *modelStats;
+    ModelRouter *modelRouter;
+    TranslationMemory *translationMemory;
+    StallWatchdog *stallWatchdog;
+    MetricsExporter *metricsExporter;
+    ReportScheduler *reportScheduler;
+    ReportBatch *reportBatch;
+    FeedbackSession *feedbackSession;
+    SpellChecker *spellChecker;
+    LanguageIdentifier *languageIdentifier;
+    ClipboardWatcher *clipboardWatcher;
+    TranslationQueue *translationQueue;
+    QHash<int, QString> translationSummaries;
+    int feedbackRequests;
+    QList<QPair<QString, QString>> queuedFeedback; // Input text and source language
+    QSystemTrayIcon *trayIcon;
+    QString lastWatchTranslation;
+    int watchGeneration;
+    QTimer *idleTimer;
+    bool idle;
     QString openaiApiKey;
 
     void retrieveOpenAIApiKey();
@@ -71,9 +146,16 @@ private:
     void cleanupProgressAndCommunicator(QDialog *progress, OpenAICommunicator *communicator);
     void setupHistoryMenu();
     void addMessageToHistory(const QString &message);
-    void setupGenerateReportMenu();
     QString formatDateForDisplay(const QDate &date);
     void generateReportForDate(const QString &dateString);
     void saveSettings();
+    void archiveOldLogsInBackground();
+    void requestFeedback(const QString &inputText, const QString &sourceLang);
+    void requestQueuedFeedback();
+    void showFeedback(const QList<SentenceFeedback> &feedback);
+    void translateCapturedText(const QString &text);
+    TranslationJob *createTranslationJob(const TranslationQueue::Entry &entry);
+    void updateQueueItem(const TranslationQueue::Entry &entry, bool delivered);
+    void leaveIdleMode();
 };
 #endif // MAINWINDOW_H
@@ -1,4 +1,7 @@
 #include "AppDataManager.h"
+#include "LogArchive.h"
+#include "StallWatchdog.h"
+#include "Metrics.h"
 #include <QStandardPaths>
 #include <QDir>
 #include <QDateTime>
@@ -7,17 +10,165 @@
 #include <QDesktopServices>
 #include <QUrl>
 #include <QtConcurrent>
+#include <QRegularExpression>
+#include <QMap>
+#include <QHash>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMutex>
+#include <climits>
+
+// Written before every log entry, followed by the time line and the text
+const char LOG_ENTRY_SEPARATOR[] = "\n\n---\n\n";
 
 AppDataManager::AppDataManager(QObject *parent)
     : QObject(parent)
+    , mistakes(new MistakeStore(getAppDataPath(), this))
+    , search(new SearchIndex(getAppDataPath(), getArchivePath(), this))
+    , days(new DayIndex(getAppDataPath(), getArchivePath(), this))
 {
 }
 
+MistakeStore *AppDataManager::mistakeStore() const {
+    return mistakes;
+}
+
+SearchIndex *AppDataManager::searchIndex() const {
+    return search;
+}
+
+DayIndex *AppDataManager::dayIndex() const {
+    return days;
+}
+
+QString AppDataManager::formatMistakesReport(const QList<MistakeRecord> &mistakes) {
+    QStringList entries;
+    for (const MistakeRecord &mistake : mistakes) {
+        entries.append(QString("ORIGINAL: %1\nCORRECTED: %2\nEXPLANATION: %3\nCATEGORY: %4")
+                           .arg(mistake.original, mistake.corrected, mistake.explanation, mistake.category));
+    }
+    if (entries.isEmpty()) {
+        return "No mistakes found.";
+    }
+    return entries.join("\n\n\n");
+}
+
 QString AppDataManager::getAppDataPath() {
     return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
 }
 
+QString AppDataManager::getArchivePath() {
+    return getAppDataPath() + "/archive";
+}
+
+int AppDataManager::archiveOldLogs(int maxAgeDays) {
+    if (maxAgeDays <= 0) {
+        return 0;
+    }
+    // Each pass rewrites whole month archives, so a second pass running at the same time
+    // could commit an archive without the files the first one just moved into it
+    static QMutex archiveMutex;
+    QMutexLocker locker(&archiveMutex);
+    QDate cutoff = QDate::currentDate().addDays(-maxAgeDays);
+
+    QMap<QString, QStringList> filesByMonth;
+    QHash<QString, QPair<qint64, QDateTime>> listed; // Size and modification time when listed
+    const QFileInfoList files = QDir(getAppDataPath()).entryInfoList({"*.txt"}, QDir::Files);
+    for (const QFileInfo &fileInfo : files) {
+        QDate date = parseDayFileName(fileInfo.fileName());
+        if (date.isValid() && date < cutoff) {
+            filesByMonth[LogArchive::monthForMember(fileInfo.fileName())].append(fileInfo.absoluteFilePath());
+            listed.insert(fileInfo.absoluteFilePath(), {fileInfo.size(), fileInfo.lastModified()});
+        }
+    }
+
+    LogArchive archive(getArchivePath());
+    int archived = 0;
+    for (auto it = filesByMonth.constBegin(); it != filesByMonth.constEnd(); ++it) {
+        if (!archive.archiveFiles(it.key(), it.value())) {
+            qDebug() << "Failed to archive logs for" << it.key();
+            continue;
+        }
+        // Originals are only removed once the archive holding them is safely on disk, and
+        // only if nothing rewrote them meanwhile; a changed file is picked up by the next pass
+        for (const QString &filePath : it.value()) {
+            QFileInfo now(filePath);
+            if (qMakePair(now.size(), now.lastModified()) != listed.value(filePath)) {
+                qDebug() << "Keeping" << filePath << "as it changed while being archived";
+                continue;
+            }
+            QFile::remove(filePath);
+            archived++;
+        }
+    }
+    if (archived > 0) {
+        qDebug() << "Archived" << archived << "log files older than" << maxAgeDays << "days";
+    }
+    return archived;
+}
+
+QDate AppDataManager::parseDayFileName(const QString &fileName, bool *isReport) {
+    static const QRegularExpression dayFilePattern("^(\\d{4}-\\d{2}-\\d{2})(-report)?\\.txt$");
+    auto match = dayFilePattern.match(fileName);
+    if (!match.hasMatch()) {
+        return QDate();
+    }
+    if (isReport) {
+        *isReport = match.hasCaptured(2);
+    }
+    return QDate::fromString(match.captured(1), "yyyy-MM-dd");
+}
+
+QList<LogEntry> AppDataManager::splitLogEntries(const QString &content) {
+    QList<LogEntry> entries;
+    for (const QString &entry : content.split(LOG_ENTRY_SEPARATOR, Qt::SkipEmptyParts)) {
+        QString text = entry.section('\n', 1).trimmed();
+        if (!text.isEmpty()) {
+            entries.append(LogEntry{entry.section('\n', 0, 0).trimmed(), text});
+        }
+    }
+    return entries;
+}
+
+QStringList AppDataManager::recentDayFiles(int maxDays) {
+    QStringList paths;
+    // Names sort by date, so the newest day comes first
+    const QFileInfoList files = QDir(getAppDataPath()).entryInfoList({"*.txt"}, QDir::Files, QDir::Name | QDir::Reversed);
+    for (const QFileInfo &fileInfo : files) {
+        bool isReport = false;
+        if (parseDayFileName(fileInfo.fileName(), &isReport).isValid() && !isReport) {
+            paths.append(fileInfo.absoluteFilePath());
+            if (paths.size() >= maxDays) {
+                break;
+            }
+        }
+    }
+    return paths;
+}
+
+QStringList AppDataManager::loggedInputs(int maxCount) {
+    QStringList inputs;
+    for (const QString &path : recentDayFiles(INT_MAX)) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            continue;
+        }
+        const QList<LogEntry> entries = splitLogEntries(QString::fromUtf8(file.readAll()));
+        for (auto it = entries.crbegin(); it != entries.crend() && inputs.size() < maxCount; ++it) {
+            inputs.append(it->text);
+        }
+        if (inputs.size() >= maxCount) {
+            break;
+        }
+    }
+    return inputs;
+}
+
 void AppDataManager::writeTranslationLog(const QString &inputText) {
+    StallWatchdog::Operation operation("AppDataManager::writeTranslationLog");
+    QElapsedTimer writeTimer;
+    writeTimer.start();
     QString appDataPath = getAppDataPath();
     QDir dir(appDataPath);
     if (!dir.exists()) {
@@ -26,15 +177,20 @@ void AppDataManager::writeTranslationLog(const QString &inputText) {
     QDateTime now = QDateTime::currentDateTime();
     QFile file(appDataPath + "/" + now.toString("yyyy-MM-dd") + ".txt");
     if (file.open(QIODevice::WriteOnly | QIODevice::Append)) {
-        file.write("\n\n---\n\n");
-        file.write(now.toString("HH:mm:ss").toUtf8() + "\n");
-        file.write(inputText.toUtf8());
-        file.write("\n");
+        qint64 written = 0;
+        written += file.write(LOG_ENTRY_SEPARATOR);
+        written += file.write(now.toString("HH:mm:ss").toUtf8() + "\n");
+        written += file.write(inputText.toUtf8());
+        written += file.write("\n");
         file.close();
+        search->addLogEntry(now.date(), now.toString("HH:mm:ss"), inputText);
+        days->recordEntry(now.date(), written);
     }
+    Metrics::instance().recordLogWrite(writeTimer.elapsed());
 }
 
 QString AppDataManager::getTodaysFileContent() const {
+    StallWatchdog::Operation operation("AppDataManager::getTodaysFileContent");
     QString appDataPath = getAppDataPath();
     QString todayFile = appDataPath + "/" + QDate::currentDate().toString("yyyy-MM-dd") + ".txt";
     QFile file(todayFile);
@@ -47,6 +203,7 @@ QString AppDataManager::getTodaysFileContent() const {
 }
 
 QString AppDataManager::getFileContentForDate(const QString &dateString) const {
+    StallWatchdog::Operation operation("AppDataManager::getFileContentForDate");
     QString appDataPath = getAppDataPath();
     QString filePath = appDataPath + "/" + dateString + ".txt";
     QFile file(filePath);
@@ -55,27 +212,31 @@ QString AppDataManager::getFileContentForDate(const QString &dateString) const {
         file.close();
         return content;
     }
-    return QString();
+    // Older days live in the monthly archives
+    return QString::fromUtf8(LogArchive(getArchivePath()).readMember(dateString + ".txt"));
 }
 
-void AppDataManager::writeMistakesReport(const QString &report) {
+void AppDataManager::writeMistakesReport(const QString &report, const QString &dateString, bool openFolder) {
+    StallWatchdog::Operation operation("AppDataManager::writeMistakesReport");
     QString appDataPath = getAppDataPath();
     QDir dir(appDataPath);
     if (!dir.exists()) {
         dir.mkpath(".");
     }
     
-    QString fileName = QDate::currentDate().toString("yyyy-MM-dd") + "-report.txt";
+    QString fileName = dateString + "-report.txt";
     QString filePath = appDataPath + "/" + fileName;
     
     QFile file(filePath);
     if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
         file.write(report.toUtf8());
         file.close();
+        search->setReport(QDate::fromString(dateString, "yyyy-MM-dd"), report);
+        days->recordReport(QDate::fromString(dateString, "yyyy-MM-dd"));
         
         // Open the folder automatically
         auto folderUrl = QUrl::fromLocalFile(appDataPath);
-        if (folderUrl.isValid()) {
+        if (openFolder && folderUrl.isValid()) {
             (void)QtConcurrent::run([folderUrl]() {
                 QDesktopServices::openUrl(folderUrl);
             });
@@ -83,27 +244,33 @@ void AppDataManager::writeMistakesReport(const QString &report) {
     }
 }
 
-void AppDataManager::writeMistakesReport(const QString &report, const QString &dateString) {
-    QString appDataPath = getAppDataPath();
-    QDir dir(appDataPath);
-    if (!dir.exists()) {
-        dir.mkpath(".");
+void AppDataManager::writeMistakesReport(const QList<MistakeRecord> &mistakeRecords, const QString &dateString, bool openFolder) {
+    StallWatchdog::Operation operation("AppDataManager::writeMistakesReport");
+    mistakes->replaceDay(QDate::fromString(dateString, "yyyy-MM-dd"), mistakeRecords);
+    writeMistakesReport(formatMistakesReport(mistakeRecords), dateString, openFolder);
+}
+
+QString AppDataManager::getReportFilePath(const QString &dateString) {
+    return getAppDataPath() + "/" + dateString + "-report.txt";
+}
+
+bool AppDataManager::hasUpToDateReport(const QString &dateString) const {
+    return days->day(QDate::fromString(dateString, "yyyy-MM-dd")).reportUpToDate();
+}
+
+QString AppDataManager::openableReportPath(const QString &dateString) const {
+    DayInfo info = days->day(QDate::fromString(dateString, "yyyy-MM-dd"));
+    if (!info.hasReport) {
+        return QString();
     }
-    
-    QString fileName = dateString + "-report.txt";
-    QString filePath = appDataPath + "/" + fileName;
-    
-    QFile file(filePath);
-    if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        file.write(report.toUtf8());
-        file.close();
-        
-        // Open the folder automatically
-        auto folderUrl = QUrl::fromLocalFile(appDataPath);
-        if (folderUrl.isValid()) {
-            (void)QtConcurrent::run([folderUrl]() {
-                QDesktopServices::openUrl(folderUrl);
-            });
-        }
+    if (!info.reportArchived) {
+        return getReportFilePath(dateString);
     }
-} 
+    QString tempPath = QStandardPaths::writableLocation(QStandardPaths::TempLocation) + "/immersion-" + dateString + "-report.txt";
+    QFile file(tempPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return QString();
+    }
+    file.write(LogArchive(getArchivePath()).readMember(dateString + "-report.txt"));
+    return tempPath;
+}
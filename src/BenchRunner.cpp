@@ -0,0 +1,221 @@
+#include "BenchRunner.h"
+#include "AppDataManager.h"
+#include "SettingsManager.h"
+#include "OpenAICommunicator.h"
+#include "NetworkThread.h"
+#include "TextSegmenter.h"
+#include "ExchangeRecorder.h"
+#include "keychainclass.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QProcessEnvironment>
+#include <algorithm>
+
+BenchRunner::BenchRunner(const Config &config_, QObject *parent)
+    : QObject(parent)
+    , config(config_)
+    , running(0)
+    , total(0)
+    , keychain(nullptr)
+{
+}
+
+bool BenchRunner::prepare() {
+    QTextStream err(stderr);
+    SettingsManager settings;
+    sourceLang = settings.sourceLang();
+    targetLang = settings.targetLang();
+
+    QStringList corpus;
+    QString defaultPrompt;
+    if (config.task == "translation") {
+        corpus = AppDataManager::loggedInputs(config.samples);
+        defaultPrompt = settings.translationPrompt();
+    } else if (config.task == "feedback") {
+        corpus = AppDataManager::loggedInputs(config.samples);
+        defaultPrompt = settings.feedbackPrompt();
+    } else if (config.task == "report") {
+        for (const QString &path : AppDataManager::recentDayFiles(config.samples)) {
+            QFile file(path);
+            if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+                corpus.append(QString::fromUtf8(file.readAll()));
+            }
+        }
+        defaultPrompt = settings.reportPrompt();
+    } else {
+        err << "Unknown bench task " << config.task << ", expected translation, feedback or report\n";
+        return false;
+    }
+    if (corpus.isEmpty()) {
+        err << "No logged inputs found in " << AppDataManager::getAppDataPath() << "\n";
+        return false;
+    }
+    if (config.models.isEmpty()) {
+        config.models.append(config.task == "translation" ? settings.translationModelName()
+                             : config.task == "feedback" ? settings.feedbackModelName()
+                             : settings.reportModelName());
+    }
+
+    QList<QPair<QString, QString>> prompts;
+    if (config.promptFiles.isEmpty()) {
+        prompts.append({"settings", defaultPrompt});
+    }
+    for (const QString &path : config.promptFiles) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            err << "Could not read prompt file " << path << "\n";
+            return false;
+        }
+        prompts.append({QFileInfo(path).baseName(), QString::fromUtf8(file.readAll()).trimmed()});
+    }
+
+    for (const QString &model : config.models) {
+        for (const auto &prompt : prompts) {
+            Combination combination;
+            combination.model = model.trimmed();
+            combination.promptLabel = prompt.first;
+            combination.prompt = QString(prompt.second).replace("%sourceLang", sourceLang).replace("%targetLang", targetLang);
+            combinations.append(combination);
+        }
+    }
+    // Interleaved, so every combination sees the same network and server conditions
+    for (const QString &input : corpus) {
+        for (int c = 0; c < combinations.size(); ++c) {
+            jobs.enqueue(Job{c, input});
+        }
+    }
+    total = jobs.size();
+    return true;
+}
+
+void BenchRunner::start() {
+    if (!prepare()) {
+        emit finished(false);
+        return;
+    }
+    QString envKey = QProcessEnvironment::systemEnvironment().value("OPENAI_API_KEY");
+    if (!envKey.isEmpty() || ExchangeRecorder::isOffline()) {
+        run(envKey.isEmpty() ? "offline" : envKey);
+        return;
+    }
+    keychain = new KeyChainClass(this);
+    connect(keychain, &KeyChainClass::keyRestored, this, [this](const QString &, const QString &value) {
+        run(value);
+    });
+    connect(keychain, &KeyChainClass::error, this, [this](const QString &errorText) {
+        // Local OpenAI-compatible servers usually don't check the key
+        QTextStream(stderr) << errorText << ", continuing without an API key\n";
+        run("none");
+    });
+    keychain->readKey("hytromo/immersion/openai_api_key");
+}
+
+void BenchRunner::run(const QString &apiKey_) {
+    apiKey = apiKey_;
+    QTextStream(stdout) << "Benchmarking " << combinations.size() << " combinations x " << total / combinations.size()
+                        << " inputs (" << config.task << ", concurrency " << config.concurrency << ") against "
+                        << OpenAICommunicator::defaultBaseUrl() << "\n";
+    launchNext();
+}
+
+RequestSpec BenchRunner::specFor(const Job &job) const {
+    const Combination &combination = combinations[job.combination];
+    RequestSpec spec;
+    spec.apiKey = apiKey;
+    spec.modelName = combination.model;
+    spec.prompt = combination.prompt;
+    spec.baseUrl = OpenAICommunicator::defaultBaseUrl();
+    spec.stream = true;
+    if (config.task == "translation") {
+        spec.inputText = job.input;
+        spec.responseFormat = ResponseFormat::Translation;
+        spec.task = Metrics::TaskTranslation;
+    } else if (config.task == "feedback") {
+        for (const TextSegment &segment : TextSegmenter::splitSentences(job.input)) {
+            if (!segment.text.trimmed().isEmpty()) {
+                spec.segments.append(segment.text.trimmed());
+            }
+        }
+        spec.responseFormat = ResponseFormat::SentenceFeedback;
+        spec.task = Metrics::TaskFeedback;
+    } else {
+        spec.inputText = job.input;
+        spec.responseFormat = ResponseFormat::MistakeReport;
+        spec.task = Metrics::TaskReport;
+    }
+    return spec;
+}
+
+void BenchRunner::launchNext() {
+    while (running < config.concurrency && !jobs.isEmpty()) {
+        Job job = jobs.dequeue();
+        int index = job.combination;
+        auto worker = new RequestWorker(specFor(job));
+        worker->moveToThread(NetworkThread::thread());
+        connect(worker, &RequestWorker::firstTokenReceived, this, [this, index](qint64 elapsedMs) {
+            combinations[index].firstTokens.append(elapsedMs);
+        });
+        connect(worker, &RequestWorker::completed, this, [this, index](qint64 elapsedMs, bool success, bool) {
+            if (success) {
+                combinations[index].latencies.append(elapsedMs);
+                combinations[index].succeeded++;
+            }
+        });
+        connect(worker, &RequestWorker::usageReceived, this, [this, index](qint64 promptTokens, qint64 completionTokens, qint64 cachedTokens, int contentChars) {
+            Combination &combination = combinations[index];
+            combination.promptTokens += promptTokens;
+            combination.cachedTokens += cachedTokens;
+            combination.completionTokens += completionTokens;
+            combination.contentChars += contentChars;
+        });
+        connect(worker, &RequestWorker::errorOccurred, this, [this, index](const QString &errorString) {
+            combinations[index].failed++;
+            QTextStream(stderr) << combinations[index].model << ": " << errorString.left(200) << "\n";
+        });
+        // The worker deletes itself once all of its results have been sent
+        connect(worker, &QObject::destroyed, this, [this]() {
+            running--;
+            if (running == 0 && jobs.isEmpty()) {
+                printReport();
+                emit finished(true);
+            } else {
+                launchNext();
+            }
+        });
+        running++;
+        QMetaObject::invokeMethod(worker, &RequestWorker::start, Qt::QueuedConnection);
+    }
+}
+
+qint64 BenchRunner::percentile(QVector<qint64> values, double p) {
+    if (values.isEmpty()) {
+        return -1;
+    }
+    std::sort(values.begin(), values.end());
+    int index = qBound(0, static_cast<int>(p * (values.size() - 1) + 0.5), static_cast<int>(values.size()) - 1);
+    return values[index];
+}
+
+void BenchRunner::printReport() {
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9 %10 %11 %12\n")
+               .arg("model", -20).arg("prompt", -12).arg("ok", 4).arg("fail", 5)
+               .arg("p50 ms", 8).arg("p90 ms", 8).arg("p99 ms", 8).arg("ttft p50", 9)
+               .arg("in tok", 8).arg("cached", 8).arg("out tok", 8).arg("chars", 7);
+    for (const Combination &combination : combinations) {
+        int n = qMax(1, combination.succeeded);
+        out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9 %10 %11 %12\n")
+                   .arg(combination.model.left(20), -20).arg(combination.promptLabel.left(12), -12)
+                   .arg(combination.succeeded, 4).arg(combination.failed, 5)
+                   .arg(percentile(combination.latencies, 0.5), 8)
+                   .arg(percentile(combination.latencies, 0.9), 8)
+                   .arg(percentile(combination.latencies, 0.99), 8)
+                   .arg(percentile(combination.firstTokens, 0.5), 9)
+                   .arg(combination.promptTokens / n, 8)
+                   .arg(combination.cachedTokens / n, 8)
+                   .arg(combination.completionTokens / n, 8)
+                   .arg(combination.contentChars / n, 7);
+    }
+    out << "Latency and time to first token are in ms; token and character counts are per request.\n";
+}
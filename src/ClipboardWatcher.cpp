@@ -0,0 +1,115 @@
+#include "ClipboardWatcher.h"
+#include "LanguageIdentifier.h"
+#include <QGuiApplication>
+#include <QMimeData>
+#include <QRegularExpression>
+
+// Selecting text with the mouse changes the selection many times, only the final text matters
+const int DEBOUNCE_MS = 700;
+const int MIN_CHARS = 12;
+const int MAX_RECENT = 50;
+// Share of characters that are common in code but rare in prose
+const double MAX_CODE_SYMBOL_RATIO = 0.06;
+
+ClipboardWatcher::ClipboardWatcher(LanguageIdentifier *languageIdentifier_, QObject *parent)
+    : QObject(parent)
+    , languageIdentifier(languageIdentifier_)
+    , debounceTimer(new QTimer(this))
+    , pendingMode(QClipboard::Clipboard)
+    , maxChars(1000)
+    , enabled(false)
+{
+    debounceTimer->setSingleShot(true);
+    debounceTimer->setInterval(DEBOUNCE_MS);
+    connect(debounceTimer, &QTimer::timeout, this, &ClipboardWatcher::debounceElapsed);
+}
+
+void ClipboardWatcher::setEnabled(bool enabled_) {
+    if (enabled == enabled_) {
+        return;
+    }
+    enabled = enabled_;
+    QClipboard *clipboard = QGuiApplication::clipboard();
+    if (enabled) {
+        connect(clipboard, &QClipboard::dataChanged, this, &ClipboardWatcher::clipboardChanged);
+        if (clipboard->supportsSelection()) {
+            connect(clipboard, &QClipboard::selectionChanged, this, &ClipboardWatcher::selectionChanged);
+        }
+    } else {
+        disconnect(clipboard, nullptr, this, nullptr);
+        debounceTimer->stop();
+    }
+}
+
+void ClipboardWatcher::setLanguages(const QStringList &languages_) {
+    languages = languages_;
+}
+
+void ClipboardWatcher::setMaxChars(int maxChars_) {
+    maxChars = maxChars_;
+}
+
+void ClipboardWatcher::clipboardChanged() {
+    // Our own translations land on the clipboard too
+    if (QGuiApplication::clipboard()->ownsClipboard()) {
+        return;
+    }
+    pendingMode = QClipboard::Clipboard;
+    debounceTimer->start();
+}
+
+void ClipboardWatcher::selectionChanged() {
+    if (QGuiApplication::clipboard()->ownsSelection()) {
+        return;
+    }
+    pendingMode = QClipboard::Selection;
+    debounceTimer->start();
+}
+
+void ClipboardWatcher::debounceElapsed() {
+    QClipboard *clipboard = QGuiApplication::clipboard();
+    const QMimeData *mimeData = clipboard->mimeData(pendingMode);
+    // KeePassXC, KDE Plasma and others mark copied passwords with this hint
+    if (!mimeData || !mimeData->hasText() || mimeData->data("x-kde-passwordManagerHint") == "secret") {
+        return;
+    }
+    QString text = mimeData->text().trimmed();
+    if (!accepts(text)) {
+        return;
+    }
+    size_t hash = qHash(text.simplified());
+    if (recentHashes.contains(hash)) {
+        return;
+    }
+    recentHashes.append(hash);
+    if (recentHashes.size() > MAX_RECENT) {
+        recentHashes.removeFirst();
+    }
+    emit textCaptured(text);
+}
+
+bool ClipboardWatcher::accepts(const QString &text) const {
+    if (text.size() < MIN_CHARS || text.size() > maxChars) {
+        return false;
+    }
+    // Passwords, tokens, hashes and URLs are a single word, prose has several
+    static const QRegularExpression whitespace("\\s");
+    if (!text.contains(whitespace) || text.startsWith("http://") || text.startsWith("https://")) {
+        return false;
+    }
+    if (looksLikeCode(text)) {
+        return false;
+    }
+    return !languageIdentifier->identify(text, languages).isEmpty();
+}
+
+bool ClipboardWatcher::looksLikeCode(const QString &text) {
+    static const QString codeSymbols = "{}[]<>;=$#|\\_`";
+    int symbols = 0;
+    for (QChar c : text) {
+        if (codeSymbols.contains(c)) {
+            symbols++;
+        }
+    }
+    return symbols > text.size() * MAX_CODE_SYMBOL_RATIO;
+}
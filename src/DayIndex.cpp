@@ -0,0 +1,237 @@
+#include "DayIndex.h"
+#include "AppDataManager.h"
+#include "LogArchive.h"
+#include "StallWatchdog.h"
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QDebug>
+
+// Saving a file often shows up as several directory changes in a row
+const int RESCAN_DELAY_MS = 500;
+// Day logs and reports; metrics, traces and the other data files do not match
+const QString DAY_FILE_GLOB = "[0-9][0-9][0-9][0-9]-[0-9][0-9]-[0-9][0-9]*.txt";
+
+static int countEntries(const QByteArray &content) {
+    return AppDataManager::splitLogEntries(QString::fromUtf8(content)).size();
+}
+
+bool DayInfo::reportUpToDate() const {
+    // Archived logs are no longer written to, so their reports cannot fall behind
+    return hasReport && (archived || !hasLog || reportModified >= logModified);
+}
+
+DayIndex::DayIndex(const QString &directoryPath_, const QString &archivePath_, QObject *parent)
+    : QObject(parent)
+    , directoryPath(directoryPath_)
+    , archivePath(archivePath_)
+    , loaded(false)
+    , archiveChanged(false)
+    , watcher(nullptr)
+    , rescanTimer(new QTimer(this))
+{
+    rescanTimer->setSingleShot(true);
+    rescanTimer->setInterval(RESCAN_DELAY_MS);
+    connect(rescanTimer, &QTimer::timeout, this, [this]() {
+        if (!loaded) {
+            return;
+        }
+        // Most changes to the folder are other files being saved next to the logs
+        if (!archiveChanged && QDir(directoryPath).entryList({DAY_FILE_GLOB}, QDir::Files, QDir::Name) == dayFileNames) {
+            return;
+        }
+        archiveChanged = false;
+        scanDirectory();
+        emit changed();
+    });
+}
+
+void DayIndex::ensureLoaded() {
+    if (loaded) {
+        return;
+    }
+    StallWatchdog::Operation operation("DayIndex::ensureLoaded");
+    loaded = true;
+    scanArchive();
+    scanDirectory();
+    watch();
+    qDebug() << "Day index built with" << days.size() << "days";
+}
+
+void DayIndex::watch() {
+    if (!watcher) {
+        watcher = new QFileSystemWatcher(this);
+        connect(watcher, &QFileSystemWatcher::directoryChanged, this, [this](const QString &path) {
+            archiveChanged = archiveChanged || path == archivePath;
+            rescanTimer->start();
+        });
+    }
+    QDir().mkpath(directoryPath);
+    watcher->addPath(directoryPath);
+    // Archiving moves days out of the folder and into here
+    QDir().mkpath(archivePath);
+    watcher->addPath(archivePath);
+}
+
+void DayIndex::scanArchive() {
+    LogArchive archive(archivePath);
+    for (const QString &month : archive.months()) {
+        for (const QString &memberName : archive.memberNames(month)) {
+            bool isReport = false;
+            QDate date = AppDataManager::parseDayFileName(memberName, &isReport);
+            if (!date.isValid()) {
+                continue;
+            }
+            DayInfo &info = days[date];
+            info.date = date;
+            info.archived = true;
+            if (!isReport) {
+                info.hasLog = true;
+            } else {
+                info.hasReport = true;
+                info.reportArchived = true;
+            }
+        }
+    }
+}
+
+void DayIndex::scanDirectory() {
+    QSet<QDate> liveLogs;
+    QSet<QDate> liveReports;
+    dayFileNames.clear();
+    const QFileInfoList files = QDir(directoryPath).entryInfoList({DAY_FILE_GLOB}, QDir::Files, QDir::Name);
+    for (const QFileInfo &fileInfo : files) {
+        dayFileNames.append(fileInfo.fileName());
+        bool isReport = false;
+        QDate date = AppDataManager::parseDayFileName(fileInfo.fileName(), &isReport);
+        if (!date.isValid()) {
+            continue;
+        }
+        DayInfo &info = days[date];
+        info.date = date;
+        if (isReport) {
+            liveReports.insert(date);
+            info.hasReport = true;
+            info.reportArchived = false;
+            info.reportModified = fileInfo.lastModified();
+            continue;
+        }
+        liveLogs.insert(date);
+        info.hasLog = true;
+        info.archived = false;
+        info.logModified = fileInfo.lastModified();
+        // Only files that changed size since the last scan are read again
+        if (info.bytes != fileInfo.size() || info.entryCount < 0) {
+            QFile file(fileInfo.absoluteFilePath());
+            if (file.open(QIODevice::ReadOnly)) {
+                info.entryCount = countEntries(file.readAll());
+                info.bytes = fileInfo.size();
+            }
+        }
+    }
+
+    // Files that disappeared were either archived or deleted
+    LogArchive archive(archivePath);
+    for (auto it = days.begin(); it != days.end();) {
+        DayInfo &info = it.value();
+        QString name = info.date.toString("yyyy-MM-dd");
+        if (info.hasLog && !info.archived && !liveLogs.contains(info.date)) {
+            info.archived = archive.contains(name + ".txt");
+            info.hasLog = info.archived;
+        }
+        if (info.hasReport && !info.reportArchived && !liveReports.contains(info.date)) {
+            info.reportArchived = archive.contains(name + "-report.txt");
+            info.hasReport = info.reportArchived;
+        }
+        if (!info.hasLog && !info.hasReport) {
+            it = days.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+QList<DayInfo> DayIndex::recentDays(int maxDays) {
+    ensureLoaded();
+    QList<DayInfo> result;
+    for (auto it = days.crbegin(); it != days.crend() && result.size() < maxDays; ++it) {
+        if (it->hasLog) {
+            result.append(*it);
+        }
+    }
+    return result;
+}
+
+QList<DayInfo> DayIndex::daysBetween(const QDate &from, const QDate &to) {
+    ensureLoaded();
+    QList<DayInfo> result;
+    for (auto it = days.lowerBound(from); it != days.end() && it.key() <= to; ++it) {
+        result.append(*it);
+    }
+    return result;
+}
+
+DayInfo DayIndex::day(const QDate &date) {
+    ensureLoaded();
+    auto it = days.find(date);
+    if (it == days.end()) {
+        DayInfo info;
+        info.date = date;
+        return info;
+    }
+    // Archived days are only decompressed when someone looks at them
+    if (it->hasLog && it->archived && it->entryCount < 0) {
+        QByteArray content = LogArchive(archivePath).readMember(date.toString("yyyy-MM-dd") + ".txt");
+        it->entryCount = countEntries(content);
+        it->bytes = content.size();
+    }
+    return *it;
+}
+
+QDate DayIndex::firstDay() {
+    ensureLoaded();
+    return days.isEmpty() ? QDate::currentDate() : days.firstKey();
+}
+
+void DayIndex::recordEntry(const QDate &date, qint64 bytes) {
+    // Counted from the file when the index is built
+    if (!loaded) {
+        return;
+    }
+    DayInfo &info = days[date];
+    info.date = date;
+    info.hasLog = true;
+    info.archived = false;
+    info.entryCount = qMax(0, info.entryCount) + 1;
+    info.bytes = qMax<qint64>(0, info.bytes) + bytes;
+    info.logModified = QDateTime::currentDateTime();
+    emit changed();
+}
+
+void DayIndex::recordReport(const QDate &date) {
+    if (!loaded) {
+        return;
+    }
+    DayInfo &info = days[date];
+    info.date = date;
+    info.hasReport = true;
+    info.reportArchived = false;
+    info.reportModified = QDateTime::currentDateTime();
+    emit changed();
+}
+
+void DayIndex::unload() {
+    if (!loaded) {
+        return;
+    }
+    loaded = false;
+    rescanTimer->stop();
+    archiveChanged = false;
+    dayFileNames.clear();
+    delete watcher;
+    watcher = nullptr;
+    days.clear();
+}
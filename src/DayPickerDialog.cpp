@@ -0,0 +1,95 @@
+#include "DayPickerDialog.h"
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+#include <QTextCharFormat>
+#include <QLocale>
+
+DayPickerDialog::DayPickerDialog(DayIndex *dayIndex_, QWidget *parent)
+    : QDialog(parent)
+    , dayIndex(dayIndex_)
+    , calendar(new QCalendarWidget(this))
+    , infoLabel(new QLabel(this))
+    , reportButton(new QPushButton("Generate report", this))
+{
+    setWindowTitle("Generate Report for a Day");
+    setAttribute(Qt::WA_DeleteOnClose);
+
+    calendar->setMinimumDate(dayIndex->firstDay());
+    calendar->setMaximumDate(QDate::currentDate());
+    calendar->setVerticalHeaderFormat(QCalendarWidget::NoVerticalHeader);
+    QList<DayInfo> latest = dayIndex->recentDays(1);
+    calendar->setSelectedDate(latest.isEmpty() ? QDate::currentDate() : latest.first().date);
+
+    auto buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    buttons->addButton(reportButton, QDialogButtonBox::AcceptRole);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(calendar);
+    layout->addWidget(infoLabel);
+    layout->addWidget(buttons);
+
+    connect(calendar, &QCalendarWidget::currentPageChanged, this, &DayPickerDialog::markMonth);
+    connect(calendar, &QCalendarWidget::selectionChanged, this, &DayPickerDialog::showSelectedDay);
+    connect(calendar, &QCalendarWidget::activated, this, &DayPickerDialog::requestReport);
+    connect(buttons, &QDialogButtonBox::accepted, this, &DayPickerDialog::requestReport);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(dayIndex, &DayIndex::changed, this, [this]() {
+        markMonth();
+        showSelectedDay();
+    });
+
+    markMonth();
+    showSelectedDay();
+}
+
+void DayPickerDialog::markMonth()
+{
+    // The calendar also shows a few days of the neighbouring months
+    QDate firstOfMonth(calendar->yearShown(), calendar->monthShown(), 1);
+    QDate from = firstOfMonth.addDays(-7);
+    QDate to = firstOfMonth.addMonths(1).addDays(14);
+
+    calendar->setDateTextFormat(QDate(), QTextCharFormat());
+    QTextCharFormat logFormat;
+    logFormat.setFontWeight(QFont::Bold);
+    QTextCharFormat reportFormat = logFormat;
+    reportFormat.setForeground(palette().color(QPalette::Link));
+    for (const DayInfo &info : dayIndex->daysBetween(from, to)) {
+        if (info.hasLog) {
+            calendar->setDateTextFormat(info.date, info.reportUpToDate() ? reportFormat : logFormat);
+        }
+    }
+}
+
+void DayPickerDialog::showSelectedDay()
+{
+    DayInfo info = dayIndex->day(calendar->selectedDate());
+    reportButton->setEnabled(info.hasLog);
+    if (!info.hasLog) {
+        infoLabel->setText("Nothing was logged on this day.");
+        reportButton->setText("Generate report");
+        return;
+    }
+    QString report;
+    if (info.reportUpToDate()) {
+        report = "report up to date";
+    } else if (info.hasReport) {
+        report = "report out of date";
+    } else {
+        report = "no report yet";
+    }
+    infoLabel->setText(QString("%1 entries, %2, %3")
+                           .arg(info.entryCount)
+                           .arg(QLocale().formattedDataSize(info.bytes), report));
+    reportButton->setText(info.reportUpToDate() ? "Open report" : "Generate report");
+}
+
+void DayPickerDialog::requestReport()
+{
+    QDate date = calendar->selectedDate();
+    if (!dayIndex->day(date).hasLog) {
+        return;
+    }
+    emit reportRequested(date.toString("yyyy-MM-dd"));
+    accept();
+}
@@ -0,0 +1,166 @@
+#include "ExchangeRecorder.h"
+#include "NetworkThread.h"
+#include "ReplayReply.h"
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QSaveFile>
+#include <QFile>
+#include <QDir>
+#include <QDebug>
+
+static const int FIXTURE_VERSION = 1;
+static const QByteArray REDACTED = "<redacted>";
+
+enum class RecorderMode { Off, Record, Replay, Stub };
+static RecorderMode s_mode = RecorderMode::Off;
+static QString s_directory;
+static double s_speed = 1.0;
+static int s_stubLatencyMs = 0;
+
+void ExchangeRecorder::startRecording(const QString &directory) {
+    s_mode = RecorderMode::Record;
+    s_directory = directory;
+    QDir().mkpath(directory);
+    qDebug() << "Recording API exchanges to" << directory;
+}
+
+void ExchangeRecorder::startReplay(const QString &directory, double speed) {
+    s_mode = RecorderMode::Replay;
+    s_directory = directory;
+    s_speed = speed;
+    qDebug() << "Replaying API exchanges from" << directory << "at speed" << speed;
+}
+
+void ExchangeRecorder::startStub(int latencyMs) {
+    s_mode = RecorderMode::Stub;
+    s_stubLatencyMs = latencyMs;
+    qDebug() << "Answering API requests from a local stub with" << latencyMs << "ms latency";
+}
+
+bool ExchangeRecorder::isRecording() {
+    return s_mode == RecorderMode::Record;
+}
+
+bool ExchangeRecorder::isOffline() {
+    return s_mode == RecorderMode::Replay || s_mode == RecorderMode::Stub;
+}
+
+QList<RecordedChunk> ExchangeRecorder::stubResponse(const QByteArray &body) {
+    auto request = QJsonDocument::fromJson(body).object();
+    auto schemaName = request["response_format"].toObject()["json_schema"].toObject()["name"].toString();
+    auto messages = request["messages"].toArray();
+    auto input = messages.isEmpty() ? QString() : messages.last().toObject()["content"].toString();
+    auto items = QJsonDocument::fromJson(input.toUtf8()).array();
+
+    QJsonObject content;
+    if (schemaName == "segmented_translation_response" || schemaName == "sentence_feedback_response") {
+        QJsonArray answers;
+        for (const auto &item : items) {
+            answers.append("stub: " + item.toString());
+        }
+        content[schemaName == "segmented_translation_response" ? "translations" : "feedback"] = answers;
+    } else if (schemaName == "mistake_report_response") {
+        content["mistakes"] = QJsonArray{QJsonObject{
+            {"original", "stub"}, {"corrected", "stub"}, {"explanation", "stub"}, {"category", "other"}}};
+    } else {
+        content["translation"] = "stub translation of " + QString::number(input.size()) + " characters";
+    }
+    auto contentText = QString::fromUtf8(QJsonDocument(content).toJson(QJsonDocument::Compact));
+    // Acts as if every prefix had been seen before; like the real API, only prefixes of 1024+ tokens count, in steps of 128
+    int prefixTokens = messages.isEmpty() ? 0 : messages.first().toObject()["content"].toString().size() / 4;
+    int cachedTokens = prefixTokens >= 1024 ? prefixTokens / 128 * 128 : 0;
+    QJsonObject usage{
+        {"prompt_tokens", body.size() / 4},
+        {"completion_tokens", contentText.size() / 4 + 1},
+        {"prompt_tokens_details", QJsonObject{{"cached_tokens", cachedTokens}}},
+    };
+    if (!request["stream"].toBool()) {
+        QJsonObject response{
+            {"choices", QJsonArray{QJsonObject{{"message", QJsonObject{{"role", "assistant"}, {"content", contentText}}}}}},
+            {"usage", usage},
+        };
+        return {RecordedChunk{s_stubLatencyMs, QJsonDocument(response).toJson(QJsonDocument::Compact)}};
+    }
+
+    // Streamed replies arrive as a few server-sent events spread over the latency
+    const int parts = 4;
+    QList<RecordedChunk> chunks;
+    int partSize = contentText.size() / parts + 1;
+    for (int i = 0; i < parts; ++i) {
+        QJsonObject event{{"choices", QJsonArray{QJsonObject{{"delta", QJsonObject{{"content", contentText.mid(i * partSize, partSize)}}}}}}};
+        chunks.append(RecordedChunk{s_stubLatencyMs * (i + 1) / parts,
+                                    "data: " + QJsonDocument(event).toJson(QJsonDocument::Compact) + "\n\n"});
+    }
+    QJsonObject usageEvent{{"choices", QJsonArray{}}, {"usage", usage}};
+    chunks.append(RecordedChunk{s_stubLatencyMs, "data: " + QJsonDocument(usageEvent).toJson(QJsonDocument::Compact) + "\n\ndata: [DONE]\n\n"});
+    return chunks;
+}
+
+QString ExchangeRecorder::fixturePath(const QByteArray &body) {
+    auto hash = QCryptographicHash::hash(body, QCryptographicHash::Sha1).toHex().left(20);
+    return s_directory + "/" + QString::fromLatin1(hash) + ".json";
+}
+
+QNetworkReply *ExchangeRecorder::post(const QNetworkRequest &request, const QByteArray &body) {
+    if (s_mode == RecorderMode::Stub) {
+        return new ReplayReply(request, 200, QNetworkReply::NoError, QString(), stubResponse(body), 1.0);
+    }
+    if (s_mode != RecorderMode::Replay) {
+        return NetworkThread::networkManager()->post(request, body);
+    }
+
+    auto path = fixturePath(body);
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return new ReplayReply(request, 0, QNetworkReply::ContentNotFoundError,
+                               "No recorded exchange for this request (" + path + ")", {}, s_speed);
+    }
+    auto fixture = QJsonDocument::fromJson(file.readAll()).object();
+    QList<RecordedChunk> chunks;
+    for (const auto &value : fixture["chunks"].toArray()) {
+        auto chunk = value.toObject();
+        chunks.append(RecordedChunk{chunk["atMs"].toInteger(), QByteArray::fromBase64(chunk["data"].toString().toLatin1())});
+    }
+    return new ReplayReply(request, fixture["status"].toInt(),
+                           static_cast<QNetworkReply::NetworkError>(fixture["error"].toInt()),
+                           fixture["errorString"].toString(), chunks, s_speed);
+}
+
+void ExchangeRecorder::save(const QNetworkRequest &request, const QByteArray &body, QNetworkReply *reply,
+                            const QList<RecordedChunk> &chunks) {
+    if (s_mode != RecorderMode::Record) {
+        return;
+    }
+    auto apiKey = request.rawHeader("Authorization").mid(QByteArray("Bearer ").size());
+    auto scrub = [&apiKey](QByteArray data) {
+        return apiKey.isEmpty() ? data : data.replace(apiKey, REDACTED);
+    };
+
+    QJsonArray recordedChunks;
+    for (const RecordedChunk &chunk : chunks) {
+        recordedChunks.append(QJsonObject{
+            {"atMs", chunk.atMs},
+            {"data", QString::fromLatin1(scrub(chunk.data).toBase64())},
+        });
+    }
+    QJsonObject fixture{
+        {"version", FIXTURE_VERSION},
+        {"url", request.url().toString()},
+        // Kept readable so fixtures can be inspected and edited by hand
+        {"request", QJsonDocument::fromJson(scrub(body)).object()},
+        {"status", reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt()},
+        {"error", static_cast<int>(reply->error())},
+        {"errorString", reply->error() == QNetworkReply::NoError ? QString() : reply->errorString()},
+        {"chunks", recordedChunks},
+    };
+
+    QSaveFile file(fixturePath(body));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write fixture" << file.fileName();
+        return;
+    }
+    file.write(QJsonDocument(fixture).toJson());
+    file.commit();
+}
@@ -8,6 +8,39 @@ FeedbackDialog::FeedbackDialog(const QString &feedback, QWidget *parent)
     , scrollArea(nullptr)
     , feedbackText(nullptr)
     , closeButton(nullptr)
+{
+    setupWindow();
+    setupUI();
+    setupScrollableArea(feedback);
+}
+
+FeedbackDialog::FeedbackDialog(const QList<SentenceFeedback> &feedback, QWidget *parent)
+    : QDialog(parent)
+    , mainLayout(nullptr)
+    , scrollArea(nullptr)
+    , feedbackText(nullptr)
+    , closeButton(nullptr)
+{
+    setupWindow();
+    setupUI();
+
+    QString html;
+    for (const SentenceFeedback &entry : feedback) {
+        QString comment = entry.feedback.trimmed().isEmpty()
+            ? "<i>No comments.</i>"
+            : entry.feedback.trimmed().toHtmlEscaped().replace("\n", "<br>");
+        // Sentences that did not change keep their earlier feedback, shown dimmed
+        html += QString("<p%1><b>%2</b>%3<br>%4</p>")
+                    .arg(entry.reused ? " style=\"color: gray;\"" : "",
+                         entry.sentence.toHtmlEscaped(),
+                         entry.reused ? " <small>(unchanged)</small>" : "",
+                         comment);
+    }
+    feedbackText->setHtml(html);
+    feedbackText->moveCursor(QTextCursor::Start);
+}
+
+void FeedbackDialog::setupWindow()
 {
     setWindowTitle("Language Feedback");
     setModal(true);
@@ -22,9 +55,6 @@ FeedbackDialog::FeedbackDialog(const QString &feedback, QWidget *parent)
         int y = (screenGeometry.height() - height()) / 2;
         move(x, y);
     }
-    
-    setupUI();
-    setupScrollableArea(feedback);
 }
 
 void FeedbackDialog::setupUI()
@@ -0,0 +1,52 @@
+#include "FeedbackSession.h"
+#include "TextSegmenter.h"
+#include <QSet>
+
+FeedbackSession::FeedbackSession(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void FeedbackSession::setContext(const QString &context_) {
+    if (context_ != context) {
+        context = context_;
+        feedbackBySentence.clear();
+    }
+}
+
+QStringList FeedbackSession::changedSentences(const QString &inputText) {
+    currentSentences.clear();
+    QStringList changed;
+    QSet<QString> seen;
+    for (const TextSegment &segment : TextSegmenter::splitSentences(inputText)) {
+        QString sentence = segment.text.trimmed();
+        if (sentence.isEmpty()) {
+            continue;
+        }
+        currentSentences.append(sentence);
+        if (!feedbackBySentence.contains(sentence) && !seen.contains(sentence)) {
+            seen.insert(sentence);
+            changed.append(sentence);
+        }
+    }
+    return changed;
+}
+
+QList<SentenceFeedback> FeedbackSession::merge(const QStringList &requested, const QStringList &feedback) {
+    QSet<QString> fresh;
+    for (int i = 0; i < requested.size() && i < feedback.size(); ++i) {
+        feedbackBySentence.insert(requested[i], feedback[i]);
+        fresh.insert(requested[i]);
+    }
+
+    QList<SentenceFeedback> merged;
+    QHash<QString, QString> kept;
+    for (const QString &sentence : currentSentences) {
+        QString sentenceFeedback = feedbackBySentence.value(sentence);
+        merged.append(SentenceFeedback{sentence, sentenceFeedback, !fresh.contains(sentence)});
+        kept.insert(sentence, sentenceFeedback);
+    }
+    // Only the latest submission is diffed against, so older sentences are dropped
+    feedbackBySentence = kept;
+    return merged;
+}
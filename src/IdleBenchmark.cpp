@@ -0,0 +1,83 @@
+#include "IdleBenchmark.h"
+#include "mainwindow.h"
+#include "SoakRunner.h"
+#include <QAbstractEventDispatcher>
+#include <QCoreApplication>
+#include <QPlainTextEdit>
+#include <QCheckBox>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+const int POLL_INTERVAL_MS = 20;
+// Gives the queued heap trim on the network thread time to run
+const int SETTLE_MS = 1000;
+
+IdleBenchmark::IdleBenchmark(MainWindow *window_, int seconds_, QObject *parent)
+    : QObject(parent)
+    , window(window_)
+    , seconds(seconds_)
+    , pollTimer(new QTimer(this))
+    , wakeups(0)
+{
+    pollTimer->setInterval(POLL_INTERVAL_MS);
+    connect(pollTimer, &QTimer::timeout, this, &IdleBenchmark::waitForTranslation);
+}
+
+void IdleBenchmark::start() {
+    // One translation warms up the network stack, caches and menus like real use does
+    window->findChild<QPlainTextEdit*>("inputText")->setPlainText("Dette er en test af tomgangstilstanden. Vi skriver en sætning mere.");
+    window->findChild<QCheckBox*>("quickFeedbackCheckBox")->setChecked(false);
+    window->show();
+    QMetaObject::invokeMethod(window, "on_goButton_clicked");
+    pollTimer->start();
+}
+
+void IdleBenchmark::waitForTranslation() {
+    // The window hides itself once the translation is on the clipboard
+    if (window->isVisible()) {
+        return;
+    }
+    pollTimer->stop();
+    QTimer::singleShot(SETTLE_MS, this, [this]() {
+        measure("hidden", [this]() {
+            window->enterIdleMode();
+            QTimer::singleShot(SETTLE_MS, this, [this]() {
+                measure("idle mode", [this]() {
+                    restore();
+                });
+            });
+        });
+    });
+}
+
+void IdleBenchmark::countWakeup() {
+    wakeups++;
+}
+
+void IdleBenchmark::measure(const QString &name, std::function<void()> then) {
+    QAbstractEventDispatcher *dispatcher = QAbstractEventDispatcher::instance();
+    wakeups = 0;
+    connect(dispatcher, &QAbstractEventDispatcher::awake, this, &IdleBenchmark::countWakeup);
+    QTimer::singleShot(seconds * 1000, this, [=]() {
+        disconnect(dispatcher, &QAbstractEventDispatcher::awake, this, &IdleBenchmark::countWakeup);
+        phases.append(Phase{name, SoakRunner::residentMemoryKb(), static_cast<double>(wakeups) / seconds});
+        then();
+    });
+}
+
+void IdleBenchmark::restore() {
+    QElapsedTimer timer;
+    timer.start();
+    window->show();
+    QCoreApplication::processEvents();
+    qint64 restoreMs = timer.elapsed();
+
+    QTextStream out(stdout);
+    out << "Idle benchmark, " << seconds << " s per phase\n";
+    for (const Phase &phase : phases) {
+        out << QString("  %1 RSS %2 kB, %3 GUI thread wakeups/s\n")
+                   .arg(phase.name, -10).arg(phase.rssKb, 8).arg(phase.wakeupsPerSecond, 0, 'f', 1);
+    }
+    out << "  restoring the window took " << restoreMs << " ms\n";
+    emit finished(!window->isIdle());
+}
@@ -0,0 +1,307 @@
+#include "LanguageIdentifier.h"
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <cmath>
+
+const int FEATURE_BUCKETS = 4096;
+// Fewer letters than this say too little about the language to act on
+const int MIN_LETTERS = 8;
+// The winner must score this much higher than the runner-up
+const double MIN_MARGIN = 1.15;
+const double MIN_PROFILE_WEIGHT = 100.0;
+
+namespace {
+struct SeedLanguage {
+    const char *name;
+    QStringList sentences;
+};
+
+const QList<SeedLanguage> &seedLanguages() {
+    static const QList<SeedLanguage> seeds{
+        {"English", {
+            "All human beings are born free and equal in dignity and rights.",
+            "They are endowed with reason and conscience and should act towards one another in a spirit of brotherhood.",
+            "I would like to book a table for two people this evening, if that is possible.",
+            "The weather was much better yesterday, so we went for a long walk by the sea.",
+            "Could you tell me where the nearest train station is?"}},
+        {"Danish", {
+            "Alle mennesker er født frie og lige i værdighed og rettigheder.",
+            "De er udstyret med fornuft og samvittighed, og de bør handle mod hverandre i en broderskabets ånd.",
+            "Jeg vil gerne bestille et bord til to personer i aften, hvis det er muligt.",
+            "Vejret var meget bedre i går, så vi gik en lang tur ved havet.",
+            "Kan du fortælle mig, hvor den nærmeste togstation er?"}},
+        {"Norwegian", {
+            "Alle mennesker er født frie og med samme menneskeverd og menneskerettigheter.",
+            "De er utstyrt med fornuft og samvittighet og bør handle mot hverandre i brorskapets ånd.",
+            "Jeg vil gjerne bestille et bord til to personer i kveld, hvis det er mulig.",
+            "Været var mye bedre i går, så vi gikk en lang tur ved sjøen.",
+            "Kan du fortelle meg hvor den nærmeste togstasjonen er?"}},
+        {"Swedish", {
+            "Alla människor är födda fria och lika i värde och rättigheter.",
+            "De har utrustats med förnuft och samvete och bör handla gentemot varandra i en anda av broderskap.",
+            "Jag skulle vilja boka ett bord för två personer i kväll, om det är möjligt.",
+            "Vädret var mycket bättre i går, så vi tog en lång promenad vid havet.",
+            "Kan du berätta var närmaste tågstation ligger?"}},
+        {"German", {
+            "Alle Menschen sind frei und gleich an Würde und Rechten geboren.",
+            "Sie sind mit Vernunft und Gewissen begabt und sollen einander im Geist der Brüderlichkeit begegnen.",
+            "Ich möchte heute Abend gerne einen Tisch für zwei Personen reservieren, wenn das möglich ist.",
+            "Das Wetter war gestern viel besser, also sind wir lange am Meer spazieren gegangen.",
+            "Können Sie mir sagen, wo der nächste Bahnhof ist?"}},
+        {"Dutch", {
+            "Alle mensen worden vrij en gelijk in waardigheid en rechten geboren.",
+            "Zij zijn begiftigd met verstand en geweten, en behoren zich jegens elkander in een geest van broederschap te gedragen.",
+            "Ik wil graag een tafel voor twee personen reserveren voor vanavond, als dat mogelijk is.",
+            "Het weer was gisteren veel beter, dus we hebben een lange wandeling langs de zee gemaakt.",
+            "Kunt u mij vertellen waar het dichtstbijzijnde treinstation is?"}},
+        {"French", {
+            "Tous les êtres humains naissent libres et égaux en dignité et en droits.",
+            "Ils sont doués de raison et de conscience et doivent agir les uns envers les autres dans un esprit de fraternité.",
+            "Je voudrais réserver une table pour deux personnes ce soir, si c'est possible.",
+            "Il faisait beaucoup plus beau hier, alors nous avons fait une longue promenade au bord de la mer.",
+            "Pourriez-vous me dire où se trouve la gare la plus proche ?"}},
+        {"Spanish", {
+            "Todos los seres humanos nacen libres e iguales en dignidad y derechos.",
+            "Dotados como están de razón y conciencia, deben comportarse fraternalmente los unos con los otros.",
+            "Me gustaría reservar una mesa para dos personas esta noche, si es posible.",
+            "Ayer hizo mucho mejor tiempo, así que dimos un largo paseo junto al mar.",
+            "¿Podría decirme dónde está la estación de tren más cercana?"}},
+        {"Italian", {
+            "Tutti gli esseri umani nascono liberi ed eguali in dignità e diritti.",
+            "Essi sono dotati di ragione e di coscienza e devono agire gli uni verso gli altri in spirito di fratellanza.",
+            "Vorrei prenotare un tavolo per due persone stasera, se è possibile.",
+            "Ieri il tempo era molto più bello, quindi abbiamo fatto una lunga passeggiata in riva al mare.",
+            "Potrebbe dirmi dov'è la stazione ferroviaria più vicina?"}},
+        {"Portuguese", {
+            "Todos os seres humanos nascem livres e iguais em dignidade e em direitos.",
+            "Dotados de razão e de consciência, devem agir uns para com os outros em espírito de fraternidade.",
+            "Gostaria de reservar uma mesa para duas pessoas esta noite, se for possível.",
+            "Ontem o tempo estava muito melhor, por isso fizemos um longo passeio à beira-mar.",
+            "Pode dizer-me onde fica a estação de comboios mais próxima?"}},
+        {"Finnish", {
+            "Kaikki ihmiset syntyvät vapaina ja tasavertaisina arvoltaan ja oikeuksiltaan.",
+            "Heille on annettu järki ja omatunto, ja heidän on toimittava toisiaan kohtaan veljeyden hengessä.",
+            "Haluaisin varata pöydän kahdelle hengelle tänä iltana, jos se on mahdollista.",
+            "Sää oli eilen paljon parempi, joten teimme pitkän kävelyn meren rannalla.",
+            "Voisitteko kertoa, missä lähin rautatieasema on?"}},
+        {"Polish", {
+            "Wszyscy ludzie rodzą się wolni i równi pod względem swej godności i swych praw.",
+            "Są oni obdarzeni rozumem i sumieniem i powinni postępować wobec innych w duchu braterstwa.",
+            "Chciałbym zarezerwować stolik dla dwóch osób na dzisiejszy wieczór, jeśli to możliwe.",
+            "Wczoraj pogoda była znacznie lepsza, więc poszliśmy na długi spacer nad morzem.",
+            "Czy może mi pan powiedzieć, gdzie jest najbliższa stacja kolejowa?"}},
+        {"Greek", {
+            "Όλοι οι άνθρωποι γεννιούνται ελεύθεροι και ίσοι στην αξιοπρέπεια και τα δικαιώματα.",
+            "Είναι προικισμένοι με λογική και συνείδηση, και οφείλουν να συμπεριφέρονται μεταξύ τους με πνεύμα αδελφοσύνης.",
+            "Θα ήθελα να κλείσω ένα τραπέζι για δύο άτομα απόψε, αν είναι δυνατόν.",
+            "Ο καιρός ήταν πολύ καλύτερος χθες, οπότε κάναμε μια μεγάλη βόλτα δίπλα στη θάλασσα.",
+            "Μπορείτε να μου πείτε πού είναι ο πλησιέστερος σιδηροδρομικός σταθμός;"}},
+    };
+    return seeds;
+}
+
+inline uint bucket(uint a, uint b, uint c) {
+    return ((a * 2654435761u) ^ (b * 2246822519u) ^ (c * 3266489917u)) % FEATURE_BUCKETS;
+}
+}
+
+LanguageIdentifier::LanguageIdentifier(QObject *parent)
+    : QObject(parent)
+{
+    for (const SeedLanguage &seed : seedLanguages()) {
+        for (const QString &sentence : seed.sentences) {
+            addText(seed.name, sentence, 1.0f);
+        }
+    }
+}
+
+QVector<float> LanguageIdentifier::features(const QString &text, int *letterCount) {
+    QVector<float> vector(FEATURE_BUCKETS, 0.0f);
+    int letters = 0;
+    // Letters only, lowercased, with every other run of characters collapsed into one space
+    uint previous2 = ' ';
+    uint previous1 = ' ';
+    auto add = [&](uint current) {
+        if (current == ' ' && previous1 == ' ') {
+            return;
+        }
+        vector[bucket(0, previous1, current)] += 1.0f;
+        vector[bucket(previous2, previous1, current)] += 1.0f;
+        previous2 = previous1;
+        previous1 = current;
+    };
+    for (QChar ch : text) {
+        if (ch.isLetter()) {
+            add(ch.toLower().unicode());
+            letters++;
+        } else {
+            add(' ');
+        }
+    }
+    add(' ');
+    if (letterCount) {
+        *letterCount = letters;
+    }
+    return vector;
+}
+
+void LanguageIdentifier::addText(const QString &language, const QString &text, float weight) {
+    Profile &profile = profiles[language.toLower()];
+    if (profile.counts.isEmpty()) {
+        profile.counts.fill(0.0f, FEATURE_BUCKETS);
+    }
+    QVector<float> vector = features(text);
+    double norm = 0.0;
+    double total = 0.0;
+    for (int i = 0; i < FEATURE_BUCKETS; ++i) {
+        profile.counts[i] = std::max(0.0f, profile.counts[i] + weight * vector[i]);
+        norm += double(profile.counts[i]) * profile.counts[i];
+        total += profile.counts[i];
+    }
+    profile.norm = std::sqrt(norm);
+    profile.total = total;
+}
+
+void LanguageIdentifier::learn(const QString &language, const QString &text) {
+    if (!language.trimmed().isEmpty()) {
+        addText(language, text, 1.0f);
+    }
+}
+
+bool LanguageIdentifier::hasProfile(const QString &language) const {
+    auto it = profiles.constFind(language.toLower());
+    return it != profiles.constEnd() && it->total >= MIN_PROFILE_WEIGHT;
+}
+
+QStringList LanguageIdentifier::languages() const {
+    return profiles.keys();
+}
+
+double LanguageIdentifier::score(const QString &language, const QString &text) const {
+    auto it = profiles.constFind(language.toLower());
+    if (it == profiles.constEnd() || it->norm == 0.0) {
+        return 0.0;
+    }
+    QVector<float> vector = features(text);
+    double dot = 0.0;
+    double norm = 0.0;
+    for (int i = 0; i < FEATURE_BUCKETS; ++i) {
+        dot += double(vector[i]) * it->counts[i];
+        norm += double(vector[i]) * vector[i];
+    }
+    return norm == 0.0 ? 0.0 : dot / (std::sqrt(norm) * it->norm);
+}
+
+QString LanguageIdentifier::bestOf(const QString &text, const QStringList &candidates, double *margin, int *letterCount) const {
+    QVector<float> vector = features(text, letterCount);
+    double inputNorm = 0.0;
+    QVector<int> nonZero;
+    for (int i = 0; i < FEATURE_BUCKETS; ++i) {
+        if (vector[i] != 0.0f) {
+            nonZero.append(i);
+            inputNorm += double(vector[i]) * vector[i];
+        }
+    }
+    QString best;
+    double bestScore = 0.0;
+    double secondScore = 0.0;
+    for (const QString &candidate : candidates) {
+        auto it = profiles.constFind(candidate.toLower());
+        if (it == profiles.constEnd() || it->norm == 0.0) {
+            continue;
+        }
+        // Short inputs only touch a handful of buckets, so the dot product skips the rest
+        double dot = 0.0;
+        for (int i : nonZero) {
+            dot += double(vector[i]) * it->counts[i];
+        }
+        double candidateScore = dot / (std::sqrt(inputNorm) * it->norm);
+        if (candidateScore > bestScore) {
+            secondScore = bestScore;
+            bestScore = candidateScore;
+            best = candidate;
+        } else if (candidateScore > secondScore) {
+            secondScore = candidateScore;
+        }
+    }
+    if (margin) {
+        *margin = secondScore > 0.0 ? bestScore / secondScore : (bestScore > 0.0 ? INFINITY : 0.0);
+    }
+    return best;
+}
+
+QString LanguageIdentifier::identify(const QString &text, const QStringList &candidates) const {
+    for (const QString &candidate : candidates) {
+        if (!hasProfile(candidate)) {
+            return QString();
+        }
+    }
+    double margin = 0.0;
+    int letters = 0;
+    QString best = bestOf(text, candidates, &margin, &letters);
+    if (letters < MIN_LETTERS || margin < MIN_MARGIN) {
+        return QString();
+    }
+    return best;
+}
+
+QString LanguageIdentifier::runBenchmark() {
+    QString report;
+    QTextStream out(&report);
+    const QList<int> prefixLengths{20, 40, 0};
+    QStringList allLanguages;
+    for (const SeedLanguage &seed : seedLanguages()) {
+        allLanguages.append(seed.name);
+    }
+
+    // Leave-one-out: each sentence is identified by profiles that never saw it
+    LanguageIdentifier identifier;
+    QList<int> correct(prefixLengths.size(), 0);
+    QList<int> pairCorrect(prefixLengths.size(), 0);
+    int total = 0;
+    QStringList samples;
+    for (const SeedLanguage &seed : seedLanguages()) {
+        for (const QString &sentence : seed.sentences) {
+            identifier.addText(seed.name, sentence, -1.0f);
+            for (int p = 0; p < prefixLengths.size(); ++p) {
+                QString input = prefixLengths[p] > 0 ? sentence.left(prefixLengths[p]) : sentence;
+                samples.append(input);
+                if (identifier.bestOf(input, allLanguages, nullptr, nullptr) == seed.name) {
+                    correct[p]++;
+                }
+                // The decision the app actually makes: source or target language
+                QString other = seed.name == QString("English") ? "Danish" : "English";
+                if (identifier.bestOf(input, {seed.name, other}, nullptr, nullptr) == seed.name) {
+                    pairCorrect[p]++;
+                }
+            }
+            identifier.addText(seed.name, sentence, 1.0f);
+            total++;
+        }
+    }
+
+    out << "Language identification benchmark (" << allLanguages.size() << " languages, "
+        << total << " held-out sentences)\n";
+    for (int p = 0; p < prefixLengths.size(); ++p) {
+        QString label = prefixLengths[p] > 0 ? QString("first %1 chars").arg(prefixLengths[p]) : QString("full sentence");
+        out << QString("  %1: %2% among all languages, %3% between two\n")
+                   .arg(label, -16)
+                   .arg(100.0 * correct[p] / total, 0, 'f', 1)
+                   .arg(100.0 * pairCorrect[p] / total, 0, 'f', 1);
+    }
+
+    const int rounds = 200;
+    QElapsedTimer timer;
+    timer.start();
+    int found = 0;
+    for (int round = 0; round < rounds; ++round) {
+        for (const QString &sample : samples) {
+            found += identifier.identify(sample, {"Danish", "English"}).isEmpty() ? 0 : 1;
+        }
+    }
+    double microseconds = timer.nsecsElapsed() / 1000.0 / (rounds * samples.size());
+    out << QString("  %1 us per message (source/target decision, %2 messages)\n")
+               .arg(microseconds, 0, 'f', 2).arg(rounds * samples.size());
+    Q_UNUSED(found);
+    return report;
+}
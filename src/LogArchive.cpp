@@ -0,0 +1,146 @@
+#include "LogArchive.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QDebug>
+
+const quint32 LOG_ARCHIVE_MAGIC = 0x494d4c41; // "IMLA"
+const quint32 LOG_ARCHIVE_VERSION = 1;
+const QString LOG_ARCHIVE_SUFFIX = ".imlog";
+
+LogArchive::LogArchive(const QString &directoryPath_)
+    : directoryPath(directoryPath_)
+{
+}
+
+QString LogArchive::monthForMember(const QString &memberName) {
+    // Members are named after their day, e.g. "2024-03-17.txt" or "2024-03-17-report.txt"
+    return memberName.left(7);
+}
+
+QString LogArchive::archivePath(const QString &month) const {
+    return directoryPath + "/" + month + LOG_ARCHIVE_SUFFIX;
+}
+
+QList<LogArchive::IndexEntry> LogArchive::readIndex(const QString &month) const {
+    QList<IndexEntry> index;
+    QFile file(archivePath(month));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return index;
+    }
+    QDataStream in(&file);
+    quint32 magic = 0, version = 0, count = 0;
+    in >> magic >> version >> count;
+    if (magic != LOG_ARCHIVE_MAGIC || version != LOG_ARCHIVE_VERSION) {
+        qDebug() << "Ignoring log archive with unknown format:" << file.fileName();
+        return index;
+    }
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        IndexEntry entry;
+        in >> entry.name >> entry.offset >> entry.size;
+        index.append(entry);
+    }
+    if (in.status() != QDataStream::Ok) {
+        index.clear();
+    }
+    return index;
+}
+
+bool LogArchive::contains(const QString &memberName) const {
+    for (const IndexEntry &entry : readIndex(monthForMember(memberName))) {
+        if (entry.name == memberName) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QByteArray LogArchive::readMember(const QString &memberName) const {
+    QString month = monthForMember(memberName);
+    for (const IndexEntry &entry : readIndex(month)) {
+        if (entry.name != memberName) {
+            continue;
+        }
+        QFile file(archivePath(month));
+        if (!file.open(QIODevice::ReadOnly) || !file.seek(entry.offset)) {
+            return QByteArray();
+        }
+        return qUncompress(file.read(entry.size));
+    }
+    return QByteArray();
+}
+
+QStringList LogArchive::memberNames(const QString &month) const {
+    QStringList names;
+    for (const IndexEntry &entry : readIndex(month)) {
+        names.append(entry.name);
+    }
+    return names;
+}
+
+QStringList LogArchive::months() const {
+    QStringList result;
+    const QStringList files = QDir(directoryPath).entryList({"*" + LOG_ARCHIVE_SUFFIX}, QDir::Files, QDir::Name);
+    for (const QString &fileName : files) {
+        result.append(fileName.chopped(LOG_ARCHIVE_SUFFIX.length()));
+    }
+    return result;
+}
+
+QMap<QString, QByteArray> LogArchive::readCompressedMembers(const QString &month) const {
+    QMap<QString, QByteArray> members;
+    QFile file(archivePath(month));
+    const auto index = readIndex(month);
+    if (index.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return members;
+    }
+    for (const IndexEntry &entry : index) {
+        if (file.seek(entry.offset)) {
+            members.insert(entry.name, file.read(entry.size));
+        }
+    }
+    return members;
+}
+
+bool LogArchive::archiveFiles(const QString &month, const QStringList &filePaths) {
+    QDir().mkpath(directoryPath);
+
+    // Existing members are carried over still compressed; files being archived replace them
+    QMap<QString, QByteArray> members = readCompressedMembers(month);
+    for (const QString &filePath : filePaths) {
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qDebug() << "Could not read" << filePath << "for archiving";
+            return false;
+        }
+        members.insert(QFileInfo(filePath).fileName(), qCompress(file.readAll(), 9));
+    }
+
+    // Work out where each member will land: header, then the index, then the data
+    QByteArray indexBytes;
+    qint64 dataOffset = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        indexBytes.clear();
+        QDataStream indexStream(&indexBytes, QIODevice::WriteOnly);
+        indexStream << LOG_ARCHIVE_MAGIC << LOG_ARCHIVE_VERSION << static_cast<quint32>(members.size());
+        qint64 offset = dataOffset;
+        for (auto it = members.constBegin(); it != members.constEnd(); ++it) {
+            indexStream << it.key() << offset << static_cast<qint64>(it.value().size());
+            offset += it.value().size();
+        }
+        // The index size does not depend on the offset values, so two passes are enough
+        dataOffset = indexBytes.size();
+    }
+
+    QSaveFile archive(archivePath(month));
+    if (!archive.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    archive.write(indexBytes);
+    for (auto it = members.constBegin(); it != members.constEnd(); ++it) {
+        archive.write(it.value());
+    }
+    return archive.commit();
+}
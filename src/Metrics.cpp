@@ -0,0 +1,230 @@
+#include "Metrics.h"
+#include <QMutexLocker>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+const std::array<qint64, Metrics::BUCKET_COUNT> Metrics::BUCKET_BOUNDS_MS = {
+    10, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 30000
+};
+
+static const char *HISTOGRAM_NAMES[] = {"request_latency_ms", "first_byte_ms"};
+
+Metrics &Metrics::instance() {
+    static Metrics metrics;
+    return metrics;
+}
+
+QString Metrics::taskName(Task task) {
+    switch (task) {
+        case TaskTranslation: return QStringLiteral("translation");
+        case TaskReport: return QStringLiteral("report");
+        case TaskFeedback: return QStringLiteral("feedback");
+        default: return QStringLiteral("unknown");
+    }
+}
+
+QString Metrics::errorClassName(ErrorClass errorClass) {
+    switch (errorClass) {
+        case ErrorNetwork: return QStringLiteral("network");
+        case ErrorTimeout: return QStringLiteral("timeout");
+        case ErrorRateLimit: return QStringLiteral("rate_limit");
+        case ErrorClient: return QStringLiteral("client");
+        case ErrorServer: return QStringLiteral("server");
+        case ErrorParse: return QStringLiteral("parse");
+        default: return QStringLiteral("unknown");
+    }
+}
+
+void Metrics::Histogram::record(qint64 elapsedMs) {
+    int bucket = 0;
+    while (bucket < BUCKET_COUNT && elapsedMs > BUCKET_BOUNDS_MS[bucket]) {
+        ++bucket;
+    }
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sumMs.fetch_add(static_cast<quint64>(qMax<qint64>(0, elapsedMs)), std::memory_order_relaxed);
+}
+
+int Metrics::modelSlot(const QString &model) {
+    // Fast path: models are registered once and never removed, so readers need no lock
+    for (int i = 0; i < MAX_MODELS; ++i) {
+        if (!models[i].used.load(std::memory_order_acquire)) {
+            break;
+        }
+        if (models[i].name == model) {
+            return i;
+        }
+    }
+    QMutexLocker locker(&modelRegistration);
+    for (int i = 0; i < MAX_MODELS; ++i) {
+        if (!models[i].used.load(std::memory_order_acquire)) {
+            models[i].name = model;
+            models[i].used.store(true, std::memory_order_release);
+            return i;
+        }
+        if (models[i].name == model) {
+            return i;
+        }
+    }
+    return MAX_MODELS;
+}
+
+void Metrics::recordRequest(Task task, const QString &model) {
+    models[modelSlot(model)].requests[task].fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::recordError(Task task, ErrorClass errorClass) {
+    errors[task][errorClass].fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::recordTokens(Task task, qint64 prompt, qint64 completion, qint64 cachedPrompt) {
+    promptTokens[task].fetch_add(static_cast<quint64>(prompt), std::memory_order_relaxed);
+    completionTokens[task].fetch_add(static_cast<quint64>(completion), std::memory_order_relaxed);
+    cachedPromptTokens[task].fetch_add(static_cast<quint64>(cachedPrompt), std::memory_order_relaxed);
+}
+
+void Metrics::recordLatency(Task task, HistogramId histogram, qint64 elapsedMs) {
+    histograms[task][histogram].record(elapsedMs);
+}
+
+void Metrics::recordLogWrite(qint64 elapsedMs) {
+    logWrites.record(elapsedMs);
+}
+
+void Metrics::recordMemoryLookups(int lookups, int hits) {
+    memoryLookups.fetch_add(static_cast<quint64>(lookups), std::memory_order_relaxed);
+    memoryHits.fetch_add(static_cast<quint64>(hits), std::memory_order_relaxed);
+}
+
+static void appendHistogram(QString &out, const QString &name, const QString &labels, const std::array<std::atomic<quint64>, 11> &buckets,
+                            quint64 count, quint64 sum, const std::array<qint64, 10> &bounds) {
+    QString separator = labels.isEmpty() ? QString() : ",";
+    quint64 cumulative = 0;
+    for (size_t i = 0; i < bounds.size(); ++i) {
+        cumulative += buckets[i].load(std::memory_order_relaxed);
+        out += QString("%1_bucket{%2%3le=\"%4\"} %5\n").arg(name, labels, separator).arg(bounds[i]).arg(cumulative);
+    }
+    out += QString("%1_bucket{%2%3le=\"+Inf\"} %4\n").arg(name, labels, separator).arg(count);
+    out += QString("%1_sum{%2} %3\n").arg(name, labels).arg(sum);
+    out += QString("%1_count{%2} %3\n").arg(name, labels).arg(count);
+}
+
+QString Metrics::toPrometheus() const {
+    QString out;
+    out += "# TYPE immersion_requests_total counter\n";
+    for (int i = 0; i <= MAX_MODELS; ++i) {
+        if (i < MAX_MODELS && !models[i].used.load(std::memory_order_acquire)) {
+            continue;
+        }
+        QString model = i < MAX_MODELS ? models[i].name : QString("other");
+        for (int task = 0; task < TaskCount; ++task) {
+            auto value = models[i].requests[task].load(std::memory_order_relaxed);
+            if (value > 0) {
+                out += QString("immersion_requests_total{task=\"%1\",model=\"%2\"} %3\n")
+                           .arg(taskName(static_cast<Task>(task)), model).arg(value);
+            }
+        }
+    }
+    out += "# TYPE immersion_errors_total counter\n";
+    for (int task = 0; task < TaskCount; ++task) {
+        for (int errorClass = 0; errorClass < ErrorClassCount; ++errorClass) {
+            out += QString("immersion_errors_total{task=\"%1\",class=\"%2\"} %3\n")
+                       .arg(taskName(static_cast<Task>(task)), errorClassName(static_cast<ErrorClass>(errorClass)))
+                       .arg(errors[task][errorClass].load(std::memory_order_relaxed));
+        }
+    }
+    out += "# TYPE immersion_prompt_tokens_total counter\n";
+    for (int task = 0; task < TaskCount; ++task) {
+        out += QString("immersion_prompt_tokens_total{task=\"%1\"} %2\n")
+                   .arg(taskName(static_cast<Task>(task))).arg(promptTokens[task].load(std::memory_order_relaxed));
+    }
+    out += "# TYPE immersion_cached_prompt_tokens_total counter\n";
+    for (int task = 0; task < TaskCount; ++task) {
+        out += QString("immersion_cached_prompt_tokens_total{task=\"%1\"} %2\n")
+                   .arg(taskName(static_cast<Task>(task))).arg(cachedPromptTokens[task].load(std::memory_order_relaxed));
+    }
+    out += "# TYPE immersion_completion_tokens_total counter\n";
+    for (int task = 0; task < TaskCount; ++task) {
+        out += QString("immersion_completion_tokens_total{task=\"%1\"} %2\n")
+                   .arg(taskName(static_cast<Task>(task))).arg(completionTokens[task].load(std::memory_order_relaxed));
+    }
+    for (int histogram = 0; histogram < HistogramCount; ++histogram) {
+        QString histogramName = QString("immersion_") + HISTOGRAM_NAMES[histogram];
+        out += QString("# TYPE %1 histogram\n").arg(histogramName);
+        for (int task = 0; task < TaskCount; ++task) {
+            const Histogram &h = histograms[task][histogram];
+            appendHistogram(out, histogramName, QString("task=\"%1\"").arg(taskName(static_cast<Task>(task))),
+                            h.buckets, h.count.load(std::memory_order_relaxed), h.sumMs.load(std::memory_order_relaxed), BUCKET_BOUNDS_MS);
+        }
+    }
+    out += "# TYPE immersion_log_write_ms histogram\n";
+    appendHistogram(out, "immersion_log_write_ms", QString(), logWrites.buckets,
+                    logWrites.count.load(std::memory_order_relaxed), logWrites.sumMs.load(std::memory_order_relaxed), BUCKET_BOUNDS_MS);
+    out += "# TYPE immersion_translation_memory_lookups_total counter\n";
+    out += QString("immersion_translation_memory_lookups_total %1\n").arg(memoryLookups.load(std::memory_order_relaxed));
+    out += "# TYPE immersion_translation_memory_hits_total counter\n";
+    out += QString("immersion_translation_memory_hits_total %1\n").arg(memoryHits.load(std::memory_order_relaxed));
+    return out;
+}
+
+static QJsonObject histogramToJson(const std::array<std::atomic<quint64>, 11> &buckets, quint64 count, quint64 sum,
+                                   const std::array<qint64, 10> &bounds) {
+    QJsonArray bucketArray;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        bucketArray.append(QJsonObject{
+            {"le", i < bounds.size() ? QJsonValue(static_cast<double>(bounds[i])) : QJsonValue("+Inf")},
+            {"count", static_cast<double>(buckets[i].load(std::memory_order_relaxed))}
+        });
+    }
+    return QJsonObject{{"buckets", bucketArray}, {"count", static_cast<double>(count)}, {"sum_ms", static_cast<double>(sum)}};
+}
+
+QByteArray Metrics::toJson() const {
+    QJsonObject root;
+    QJsonArray requests;
+    for (int i = 0; i <= MAX_MODELS; ++i) {
+        if (i < MAX_MODELS && !models[i].used.load(std::memory_order_acquire)) {
+            continue;
+        }
+        for (int task = 0; task < TaskCount; ++task) {
+            auto value = models[i].requests[task].load(std::memory_order_relaxed);
+            if (value > 0) {
+                requests.append(QJsonObject{
+                    {"task", taskName(static_cast<Task>(task))},
+                    {"model", i < MAX_MODELS ? models[i].name : QString("other")},
+                    {"count", static_cast<double>(value)}
+                });
+            }
+        }
+    }
+    root["requests"] = requests;
+
+    QJsonObject tasks;
+    for (int task = 0; task < TaskCount; ++task) {
+        QJsonObject taskObject;
+        QJsonObject errorObject;
+        for (int errorClass = 0; errorClass < ErrorClassCount; ++errorClass) {
+            errorObject[errorClassName(static_cast<ErrorClass>(errorClass))] =
+                static_cast<double>(errors[task][errorClass].load(std::memory_order_relaxed));
+        }
+        taskObject["errors"] = errorObject;
+        taskObject["prompt_tokens"] = static_cast<double>(promptTokens[task].load(std::memory_order_relaxed));
+        taskObject["completion_tokens"] = static_cast<double>(completionTokens[task].load(std::memory_order_relaxed));
+        taskObject["cached_prompt_tokens"] = static_cast<double>(cachedPromptTokens[task].load(std::memory_order_relaxed));
+        for (int histogram = 0; histogram < HistogramCount; ++histogram) {
+            const Histogram &h = histograms[task][histogram];
+            taskObject[QString(HISTOGRAM_NAMES[histogram])] =
+                histogramToJson(h.buckets, h.count.load(std::memory_order_relaxed), h.sumMs.load(std::memory_order_relaxed), BUCKET_BOUNDS_MS);
+        }
+        tasks[taskName(static_cast<Task>(task))] = taskObject;
+    }
+    root["tasks"] = tasks;
+    root["log_write_ms"] = histogramToJson(logWrites.buckets, logWrites.count.load(std::memory_order_relaxed),
+                                           logWrites.sumMs.load(std::memory_order_relaxed), BUCKET_BOUNDS_MS);
+    root["translation_memory"] = QJsonObject{
+        {"lookups", static_cast<double>(memoryLookups.load(std::memory_order_relaxed))},
+        {"hits", static_cast<double>(memoryHits.load(std::memory_order_relaxed))}
+    };
+    return QJsonDocument(root).toJson();
+}
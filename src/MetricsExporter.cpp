@@ -0,0 +1,83 @@
+#include "MetricsExporter.h"
+#include "Metrics.h"
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QSaveFile>
+#include <QDir>
+#include <QDebug>
+
+const int METRICS_WRITE_INTERVAL_MS = 15000;
+
+MetricsExporter::MetricsExporter(const QString &directoryPath_, QObject *parent)
+    : QObject(parent)
+    , directoryPath(directoryPath_)
+{
+    connect(&writeTimer, &QTimer::timeout, this, &MetricsExporter::writeFiles);
+    connect(&server, &QTcpServer::newConnection, this, &MetricsExporter::handleConnection);
+}
+
+bool MetricsExporter::start(quint16 port) {
+    writeTimer.start(METRICS_WRITE_INTERVAL_MS);
+    writeFiles();
+    if (port == 0 || server.isListening()) {
+        return true;
+    }
+    // Only reachable from this machine; scrapers run next to the app
+    if (!server.listen(QHostAddress::LocalHost, port)) {
+        qDebug() << "Could not listen for metrics scrapes on port" << port << ":" << server.errorString();
+        return false;
+    }
+    qDebug() << "Serving metrics on http://127.0.0.1:" << port << "/metrics";
+    return true;
+}
+
+void MetricsExporter::stop() {
+    writeTimer.stop();
+    server.close();
+}
+
+void MetricsExporter::writeFiles() {
+    QDir().mkpath(directoryPath);
+    QSaveFile prometheusFile(directoryPath + "/metrics.prom");
+    if (prometheusFile.open(QIODevice::WriteOnly)) {
+        prometheusFile.write(Metrics::instance().toPrometheus().toUtf8());
+        prometheusFile.commit();
+    }
+    QSaveFile jsonFile(directoryPath + "/metrics.json");
+    if (jsonFile.open(QIODevice::WriteOnly)) {
+        jsonFile.write(Metrics::instance().toJson());
+        jsonFile.commit();
+    }
+}
+
+void MetricsExporter::handleConnection() {
+    while (QTcpSocket *socket = server.nextPendingConnection()) {
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, socket, [socket]() {
+            if (!socket->canReadLine()) {
+                return;
+            }
+            // Only the request line matters, e.g. "GET /metrics HTTP/1.1"
+            auto requestLine = socket->readLine().split(' ');
+            QByteArray path = requestLine.size() > 1 ? requestLine[1] : QByteArray();
+            QByteArray body;
+            QByteArray status = "200 OK";
+            QByteArray contentType;
+            if (path == "/metrics") {
+                body = Metrics::instance().toPrometheus().toUtf8();
+                contentType = "text/plain; version=0.0.4";
+            } else if (path == "/metrics.json") {
+                body = Metrics::instance().toJson();
+                contentType = "application/json";
+            } else {
+                status = "404 Not Found";
+                contentType = "text/plain";
+                body = "Try /metrics or /metrics.json\n";
+            }
+            socket->write("HTTP/1.1 " + status + "\r\nContent-Type: " + contentType
+                          + "\r\nContent-Length: " + QByteArray::number(body.size())
+                          + "\r\nConnection: close\r\n\r\n" + body);
+            socket->disconnectFromHost();
+        });
+    }
+}
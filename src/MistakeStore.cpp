@@ -0,0 +1,194 @@
+#include "MistakeStore.h"
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QHash>
+#include <QJsonObject>
+#include <QDebug>
+#include <algorithm>
+
+const quint32 MISTAKE_COLUMNS_MAGIC = 0x494d4d43; // "IMMC"
+const quint32 MISTAKE_TEXTS_MAGIC = 0x494d4d54; // "IMMT"
+const quint32 MISTAKE_STORE_VERSION = 1;
+
+MistakeStore::MistakeStore(const QString &directoryPath, QObject *parent)
+    : QObject(parent)
+    , columnsPath(directoryPath + "/mistakes-columns.dat")
+    , textsPath(directoryPath + "/mistakes-texts.dat")
+    , loaded(false)
+    , textsLoaded(false)
+{
+}
+
+QList<MistakeRecord> MistakeStore::recordsFromJson(const QJsonArray &mistakes) {
+    QList<MistakeRecord> records;
+    for (const auto &value : mistakes) {
+        auto mistake = value.toObject();
+        records.append(MistakeRecord{
+            mistake["original"].toString(),
+            mistake["corrected"].toString(),
+            mistake["explanation"].toString(),
+            mistake["category"].toString().trimmed().toLower(),
+        });
+    }
+    return records;
+}
+
+void MistakeStore::ensureLoaded() {
+    if (loaded) {
+        return;
+    }
+    loaded = true;
+    QFile file(columnsPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    QDataStream in(&file);
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if (magic != MISTAKE_COLUMNS_MAGIC || version != MISTAKE_STORE_VERSION) {
+        qDebug() << "Ignoring mistake store with unknown format:" << columnsPath;
+        return;
+    }
+    in >> categoryDictionary >> dayColumn >> categoryColumn;
+    if (in.status() != QDataStream::Ok || dayColumn.size() != categoryColumn.size()) {
+        qDebug() << "Mistake store is corrupt, starting over:" << columnsPath;
+        categoryDictionary.clear();
+        dayColumn.clear();
+        categoryColumn.clear();
+    }
+}
+
+void MistakeStore::ensureTextsLoaded() {
+    ensureLoaded();
+    if (textsLoaded) {
+        return;
+    }
+    textsLoaded = true;
+    QFile file(textsPath);
+    if (file.open(QIODevice::ReadOnly)) {
+        QDataStream in(&file);
+        quint32 magic = 0, version = 0;
+        in >> magic >> version;
+        if (magic == MISTAKE_TEXTS_MAGIC && version == MISTAKE_STORE_VERSION) {
+            in >> originalColumn >> correctedColumn >> explanationColumn;
+        }
+    }
+    if (originalColumn.size() != dayColumn.size()
+        || correctedColumn.size() != dayColumn.size()
+        || explanationColumn.size() != dayColumn.size()) {
+        // Keep the columns aligned even if the text file went missing
+        originalColumn = QStringList();
+        correctedColumn = QStringList();
+        explanationColumn = QStringList();
+        for (int i = 0; i < dayColumn.size(); ++i) {
+            originalColumn.append(QString());
+            correctedColumn.append(QString());
+            explanationColumn.append(QString());
+        }
+    }
+}
+
+bool MistakeStore::save() {
+    QDir().mkpath(QFileInfo(columnsPath).absolutePath());
+    QSaveFile columns(columnsPath);
+    if (!columns.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream columnsOut(&columns);
+    columnsOut << MISTAKE_COLUMNS_MAGIC << MISTAKE_STORE_VERSION << categoryDictionary << dayColumn << categoryColumn;
+
+    QSaveFile texts(textsPath);
+    if (!texts.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream textsOut(&texts);
+    textsOut << MISTAKE_TEXTS_MAGIC << MISTAKE_STORE_VERSION << originalColumn << correctedColumn << explanationColumn;
+    return texts.commit() && columns.commit();
+}
+
+quint16 MistakeStore::categoryId(const QString &category) {
+    QString name = category.isEmpty() ? QString("other") : category;
+    int index = categoryDictionary.indexOf(name);
+    if (index < 0) {
+        categoryDictionary.append(name);
+        index = categoryDictionary.size() - 1;
+    }
+    return static_cast<quint16>(index);
+}
+
+int MistakeStore::lowerBound(qint32 dayNumber) const {
+    return static_cast<int>(std::lower_bound(dayColumn.begin(), dayColumn.end(), dayNumber) - dayColumn.begin());
+}
+
+void MistakeStore::replaceDay(const QDate &date, const QList<MistakeRecord> &records) {
+    ensureTextsLoaded();
+    auto dayNumber = static_cast<qint32>(date.toJulianDay());
+    int begin = lowerBound(dayNumber);
+    int end = lowerBound(dayNumber + 1);
+
+    // A regenerated report replaces whatever was stored for that day
+    dayColumn.remove(begin, end - begin);
+    categoryColumn.remove(begin, end - begin);
+    for (int i = begin; i < end; ++i) {
+        originalColumn.removeAt(begin);
+        correctedColumn.removeAt(begin);
+        explanationColumn.removeAt(begin);
+    }
+
+    int row = begin;
+    for (const MistakeRecord &record : records) {
+        dayColumn.insert(row, dayNumber);
+        categoryColumn.insert(row, categoryId(record.category));
+        originalColumn.insert(row, record.original);
+        correctedColumn.insert(row, record.corrected);
+        explanationColumn.insert(row, record.explanation);
+        ++row;
+    }
+    if (!save()) {
+        qDebug() << "Failed to save the mistake store";
+    }
+}
+
+QList<QPair<QString, int>> MistakeStore::topCategories(const QDate &from, const QDate &to, int limit) {
+    ensureLoaded();
+    QVector<int> counts(categoryDictionary.size(), 0);
+    int end = lowerBound(static_cast<qint32>(to.toJulianDay()) + 1);
+    for (int row = lowerBound(static_cast<qint32>(from.toJulianDay())); row < end; ++row) {
+        counts[categoryColumn[row]]++;
+    }
+
+    QList<QPair<QString, int>> result;
+    for (int id = 0; id < counts.size(); ++id) {
+        if (counts[id] > 0) {
+            result.append(qMakePair(categoryDictionary[id], counts[id]));
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const QPair<QString, int> &a, const QPair<QString, int> &b) {
+        return a.second > b.second;
+    });
+    return result.mid(0, limit);
+}
+
+QList<MistakeRecord> MistakeStore::recordsForCategory(const QString &category, const QDate &from, const QDate &to) {
+    ensureTextsLoaded();
+    QList<MistakeRecord> records;
+    int id = categoryDictionary.indexOf(category);
+    if (id < 0) {
+        return records;
+    }
+    int end = lowerBound(static_cast<qint32>(to.toJulianDay()) + 1);
+    for (int row = lowerBound(static_cast<qint32>(from.toJulianDay())); row < end; ++row) {
+        if (categoryColumn[row] == id) {
+            records.append(MistakeRecord{originalColumn[row], correctedColumn[row], explanationColumn[row], category});
+        }
+    }
+    return records;
+}
+
+int MistakeStore::rowCount() {
+    ensureLoaded();
+    return dayColumn.size();
+}
@@ -0,0 +1,104 @@
+#include "ModelRouter.h"
+#include "ModelStats.h"
+#include <QDebug>
+#include <QStringList>
+
+const int MIN_COMPLETIONS_FOR_DEMOTION = 3;
+const double MAX_HEALTHY_ERROR_RATE = 0.5;
+const int DEMOTION_COOLDOWN_SECONDS = 120;
+
+ModelRouter::ModelRouter(ModelStats *stats, QObject *parent)
+    : QObject(parent)
+    , modelStats(stats)
+    , latencyBudgetMs(8000)
+{
+}
+
+void ModelRouter::setTiers(const QString &tierSpec) {
+    tiers.clear();
+    const QStringList entries = tierSpec.split(',', Qt::SkipEmptyParts);
+    for (const QString &entry : entries) {
+        QStringList parts = entry.trimmed().split(':');
+        Tier tier{parts[0].trimmed(), -1};
+        if (tier.model.isEmpty()) {
+            continue;
+        }
+        if (parts.size() > 1) {
+            bool ok = false;
+            int maxTokens = parts[1].trimmed().toInt(&ok);
+            if (ok && maxTokens > 0) {
+                tier.maxTokens = maxTokens;
+            }
+        }
+        tiers.append(tier);
+    }
+}
+
+void ModelRouter::setLatencyBudgetMs(int budgetMs) {
+    latencyBudgetMs = budgetMs;
+}
+
+bool ModelRouter::hasTiers() const {
+    return !tiers.isEmpty();
+}
+
+int ModelRouter::estimateTokens(const QString &text) {
+    // Roughly four characters per token for Latin-script text
+    return text.length() / 4 + 1;
+}
+
+bool ModelRouter::isDemoted(const QString &model) const {
+    auto it = demotedUntil.constFind(model);
+    return it != demotedUntil.constEnd() && QDateTime::currentDateTimeUtc() < it.value();
+}
+
+bool ModelRouter::checkHealth(const QString &model) {
+    if (isDemoted(model)) {
+        return false;
+    }
+    if (demotedUntil.remove(model) > 0) {
+        qDebug() << "Model" << model << "cooldown over, trying it again";
+        return true;
+    }
+    if (!modelStats || modelStats->completionCount(model) < MIN_COMPLETIONS_FOR_DEMOTION) {
+        return true;
+    }
+    double errorRate = modelStats->errorRate(model);
+    double latency = modelStats->latencyEstimate(model);
+    if (errorRate > MAX_HEALTHY_ERROR_RATE || latency > latencyBudgetMs) {
+        qDebug() << "Demoting model" << model << "- error rate" << errorRate << "latency" << latency << "ms";
+        demotedUntil[model] = QDateTime::currentDateTimeUtc().addSecs(DEMOTION_COOLDOWN_SECONDS);
+        return false;
+    }
+    return true;
+}
+
+QString ModelRouter::route(const QString &inputText) {
+    if (tiers.isEmpty()) {
+        return QString();
+    }
+    int tokens = estimateTokens(inputText);
+    int preferred = tiers.size() - 1;
+    for (int i = 0; i < tiers.size(); ++i) {
+        if (tiers[i].maxTokens < 0 || tokens <= tiers[i].maxTokens) {
+            preferred = i;
+            break;
+        }
+    }
+
+    // Prefer moving up to a larger tier, then fall back to smaller ones
+    QList<int> order;
+    for (int i = preferred; i < tiers.size(); ++i) {
+        order.append(i);
+    }
+    for (int i = preferred - 1; i >= 0; --i) {
+        order.append(i);
+    }
+    for (int index : order) {
+        if (checkHealth(tiers[index].model)) {
+            return tiers[index].model;
+        }
+    }
+    // Everything is degraded; the preferred tier is still the best guess
+    return tiers[preferred].model;
+}
@@ -0,0 +1,104 @@
+#include "ModelStats.h"
+#include <algorithm>
+
+const int MAX_FIRST_BYTE_SAMPLES = 100;
+const int MIN_SAMPLES_FOR_HEDGING = 10;
+const qint64 MIN_HEDGE_DELAY_MS = 300;
+// At most this fraction of a model's requests may be duplicated
+const double HEDGE_BUDGET_RATIO = 0.1;
+// Weight of the newest completion in the latency and error estimates
+const double EWMA_ALPHA = 0.3;
+
+ModelStats::ModelStats(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void ModelStats::recordRequest(const QString &model) {
+    entries[model].requests++;
+}
+
+void ModelStats::recordFirstByte(const QString &model, qint64 elapsedMs) {
+    Entry &entry = entries[model];
+    if (entry.firstByteSamples.size() < MAX_FIRST_BYTE_SAMPLES) {
+        entry.firstByteSamples.append(elapsedMs);
+    } else {
+        // Overwrite the oldest sample so the estimate follows the current behaviour of the model
+        entry.firstByteSamples[entry.nextSample] = elapsedMs;
+        entry.nextSample = (entry.nextSample + 1) % MAX_FIRST_BYTE_SAMPLES;
+    }
+}
+
+void ModelStats::recordCompletion(const QString &model, qint64 elapsedMs, bool success) {
+    Entry &entry = entries[model];
+    // Failed requests often return quickly, so only successes move the latency estimate
+    if (success) {
+        entry.latencyEwma = entry.latencyEwma == 0.0
+            ? elapsedMs
+            : EWMA_ALPHA * elapsedMs + (1.0 - EWMA_ALPHA) * entry.latencyEwma;
+    }
+    double error = success ? 0.0 : 1.0;
+    entry.errorEwma = entry.completions == 0
+        ? error
+        : EWMA_ALPHA * error + (1.0 - EWMA_ALPHA) * entry.errorEwma;
+    entry.completions++;
+}
+
+double ModelStats::latencyEstimate(const QString &model) const {
+    return entries.value(model).latencyEwma;
+}
+
+double ModelStats::errorRate(const QString &model) const {
+    return entries.value(model).errorEwma;
+}
+
+int ModelStats::completionCount(const QString &model) const {
+    return entries.value(model).completions;
+}
+
+qint64 ModelStats::firstBytePercentile(const QString &model, double percentile) const {
+    auto it = entries.constFind(model);
+    if (it == entries.constEnd() || it->firstByteSamples.isEmpty()) {
+        return -1;
+    }
+    QVector<qint64> sorted = it->firstByteSamples;
+    std::sort(sorted.begin(), sorted.end());
+    int index = qBound(0, static_cast<int>(percentile * (sorted.size() - 1) + 0.5), sorted.size() - 1);
+    return sorted[index];
+}
+
+qint64 ModelStats::hedgeDelay(const QString &model) const {
+    auto it = entries.constFind(model);
+    if (it == entries.constEnd() || it->firstByteSamples.size() < MIN_SAMPLES_FOR_HEDGING) {
+        return -1; // Not enough data to know what "slow" means for this model
+    }
+    return qMax(MIN_HEDGE_DELAY_MS, firstBytePercentile(model, 0.9));
+}
+
+bool ModelStats::canHedge(const QString &model) const {
+    auto it = entries.constFind(model);
+    if (it == entries.constEnd()) {
+        return false;
+    }
+    return it->hedgesIssued < it->requests * HEDGE_BUDGET_RATIO + 1;
+}
+
+void ModelStats::recordHedgeIssued(const QString &model) {
+    entries[model].hedgesIssued++;
+}
+
+void ModelStats::recordHedgeWon(const QString &model) {
+    entries[model].hedgesWon++;
+}
+
+int ModelStats::requestCount(const QString &model) const {
+    return entries.value(model).requests;
+}
+
+int ModelStats::hedgesIssued(const QString &model) const {
+    return entries.value(model).hedgesIssued;
+}
+
+int ModelStats::hedgesWon(const QString &model) const {
+    return entries.value(model).hedgesWon;
+}
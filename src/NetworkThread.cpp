@@ -0,0 +1,60 @@
+#include "NetworkThread.h"
+#include <QCoreApplication>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+static QThread *s_networkThread = nullptr;
+static QNetworkAccessManager *s_networkManager = nullptr;
+
+QThread *NetworkThread::thread() {
+    if (!s_networkThread) {
+        s_networkThread = new QThread();
+        s_networkThread->setObjectName("NetworkThread");
+        s_networkThread->start();
+        QObject::connect(qApp, &QCoreApplication::aboutToQuit, []() {
+            NetworkThread::shutdown();
+        });
+    }
+    return s_networkThread;
+}
+
+QNetworkAccessManager *NetworkThread::networkManager() {
+    Q_ASSERT(QThread::currentThread() == s_networkThread);
+    if (!s_networkManager) {
+        s_networkManager = new QNetworkAccessManager();
+    }
+    return s_networkManager;
+}
+
+void NetworkThread::releaseIdleResources() {
+    if (!s_networkThread) {
+        return;
+    }
+    // The manager may only be touched from its own thread
+    auto context = new QObject();
+    context->moveToThread(s_networkThread);
+    QMetaObject::invokeMethod(context, [context]() {
+        if (s_networkManager) {
+            s_networkManager->clearConnectionCache();
+        }
+#ifdef __GLIBC__
+        // Runs after everything the GUI thread freed before queueing this, and trims all arenas
+        malloc_trim(0);
+#endif
+        delete context;
+    });
+}
+
+void NetworkThread::shutdown() {
+    if (!s_networkThread) {
+        return;
+    }
+    s_networkThread->quit();
+    s_networkThread->wait();
+    // The thread has stopped, so nothing can be using the manager any more
+    delete s_networkManager;
+    s_networkManager = nullptr;
+    delete s_networkThread;
+    s_networkThread = nullptr;
+}
@@ -1,14 +1,19 @@
 #include "OpenAICommunicator.h"
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
-#include <QNetworkRequest>
+#include "ModelStats.h"
+#include "NetworkThread.h"
+#include <QDebug>
+
+static QString s_defaultBaseUrl = "https://api.openai.com/v1";
 
 OpenAICommunicator::OpenAICommunicator(const QString &apiKey_, QObject *parent)
-    : QObject(parent), apiKey(apiKey_)
+    : QObject(parent), apiKey(apiKey_), responseFormat(ResponseFormat::Translation), task(Metrics::TaskTranslation), priority(-1), modelStats(nullptr), hedgingEnabled(false)
+{
+}
+
+OpenAICommunicator::~OpenAICommunicator()
 {
-    connect(&networkManager, &QNetworkAccessManager::finished,
-            this, &OpenAICommunicator::handleNetworkReply);
+    // Queued, and dropped by Qt if the worker has already finished and deleted itself
+    emit abortRequested();
 }
 
 void OpenAICommunicator::setModelName(const QString &name) {
@@ -32,75 +37,131 @@ void OpenAICommunicator::setPromptRaw(const QString &prompt_) {
     prompt = prompt_;
 }
 
+void OpenAICommunicator::setContext(const QString &context_) {
+    context = context_;
+}
+
+void OpenAICommunicator::setInputText(const QString &inputText_) {
+    inputText = inputText_;
+}
+
 QString OpenAICommunicator::getPrompt() const {
     return prompt;
 }
 
+void OpenAICommunicator::setSegments(const QStringList &segments_) {
+    segments = segments_;
+    responseFormat = ResponseFormat::SegmentedTranslation;
+}
+
+void OpenAICommunicator::setPriority(RequestScheduler::Priority priority_) {
+    priority = priority_;
+}
+
+void OpenAICommunicator::setResponseFormat(ResponseFormat format) {
+    responseFormat = format;
+}
+
+void OpenAICommunicator::setTask(Metrics::Task task_) {
+    task = task_;
+}
+
+void OpenAICommunicator::setModelStats(ModelStats *stats) {
+    modelStats = stats;
+}
+
+void OpenAICommunicator::setDefaultBaseUrl(const QString &baseUrl) {
+    s_defaultBaseUrl = baseUrl.trimmed();
+    while (s_defaultBaseUrl.endsWith('/')) {
+        s_defaultBaseUrl.chop(1);
+    }
+}
+
+QString OpenAICommunicator::defaultBaseUrl() {
+    return s_defaultBaseUrl;
+}
+
+void OpenAICommunicator::setHedgingEnabled(bool enabled) {
+    hedgingEnabled = enabled;
+}
+
+QString OpenAICommunicator::effectiveModelName() const {
+    return modelName.isEmpty() ? "gpt-4o-mini" : modelName;
+}
+
 void OpenAICommunicator::sendRequest() {
-    auto json = QJsonObject{};
-    json["model"] = modelName.isEmpty() ? "gpt-4o-mini" : modelName;
-
-    auto messages = QJsonArray{};
-    auto message = QJsonObject{};
-    message["role"] = "user";
-    message["content"] = prompt;
-    messages.append(message);
-    messages.append(QJsonObject{
-        {"role", "user"},
-        {"content", inputText}
+    RequestSpec spec;
+    spec.apiKey = apiKey;
+    spec.modelName = effectiveModelName();
+    spec.prompt = prompt;
+    spec.context = context;
+    spec.inputText = inputText;
+    spec.segments = segments;
+    spec.responseFormat = responseFormat;
+    spec.task = task;
+    spec.baseUrl = s_defaultBaseUrl;
+    if (modelStats) {
+        // Without streaming the first byte only arrives with the whole completion, which would
+        // make both the samples and the hedge delay total latency
+        spec.stream = true;
+        modelStats->recordRequest(spec.modelName);
+        // Hedge only once we know this model's p90 time to first byte
+        if (hedgingEnabled && modelStats->canHedge(spec.modelName)) {
+            spec.hedgeDelayMs = modelStats->hedgeDelay(spec.modelName);
+        }
+    }
+
+    RequestScheduler::Priority requestPriority = static_cast<RequestScheduler::Priority>(priority);
+    if (priority < 0) {
+        requestPriority = task == Metrics::TaskFeedback ? RequestScheduler::PriorityFeedback
+                        : task == Metrics::TaskReport ? RequestScheduler::PriorityReport
+                        : RequestScheduler::PriorityInteractive;
+    }
+    RequestScheduler::instance().submit(requestPriority, this, [this, spec]() -> QObject* {
+        // The worker belongs to the network thread; if this handle goes away first, the
+        // request is aborted so it stops using tokens and its scheduler slot
+        auto worker = new RequestWorker(spec);
+        worker->moveToThread(NetworkThread::thread());
+        connect(this, &OpenAICommunicator::abortRequested, worker, &RequestWorker::abort, Qt::QueuedConnection);
+        connect(worker, &RequestWorker::replyReceived, this, &OpenAICommunicator::replyReceived);
+        connect(worker, &RequestWorker::segmentsReceived, this, &OpenAICommunicator::segmentsReceived);
+        connect(worker, &RequestWorker::structuredReplyReceived, this, &OpenAICommunicator::structuredReplyReceived);
+        connect(worker, &RequestWorker::errorOccurred, this, &OpenAICommunicator::errorOccurred);
+        connect(worker, &RequestWorker::firstByteReceived, this, &OpenAICommunicator::handleFirstByte);
+        connect(worker, &RequestWorker::hedgeIssued, this, &OpenAICommunicator::handleHedgeIssued);
+        connect(worker, &RequestWorker::completed, this, &OpenAICommunicator::handleCompleted);
+        connect(worker, &RequestWorker::usageReceived, this, &OpenAICommunicator::handleUsage);
+        return worker;
     });
-    json["messages"] = messages;
-
-    auto schema = QJsonObject{};
-    schema["type"] = "object";
-    schema["properties"] = QJsonObject{
-        {"translation", QJsonObject{{"type", "string"}}},
-    };
-    schema["required"] = QJsonArray{"translation"};
-    schema["additionalProperties"] = false;
-
-    json["response_format"] = QJsonObject{
-        {"type", "json_schema"},
-        {"json_schema", QJsonObject{
-                            {"name", "translation_response"},
-                            {"strict", true},
-                            {"schema", schema}
-                        }}
-    };
-
-    auto request = QNetworkRequest(QUrl("https://api.openai.com/v1/chat/completions"));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", ("Bearer " + apiKey).toUtf8());
-
-    networkManager.post(request, QJsonDocument(json).toJson());
-}
-
-void OpenAICommunicator::handleNetworkReply(QNetworkReply *reply) {
-    auto responseData = reply->readAll();
-    qDebug() << responseData;
-    if (reply->error() != QNetworkReply::NoError) {
-        emit errorOccurred(reply->errorString() + " " + responseData);
-        reply->deleteLater();
-        return;
+}
+
+void OpenAICommunicator::handleFirstByte(qint64 elapsedMs) {
+    if (modelStats) {
+        modelStats->recordFirstByte(effectiveModelName(), elapsedMs);
     }
-    auto jsonDoc = QJsonDocument::fromJson(responseData);
-    auto root = jsonDoc.object();
-    auto choices = root["choices"].toArray();
-    if (choices.isEmpty()) {
-        emit errorOccurred("No choices returned.");
-        reply->deleteLater();
-        return;
+}
+
+void OpenAICommunicator::handleHedgeIssued() {
+    if (modelStats) {
+        modelStats->recordHedgeIssued(effectiveModelName());
     }
-    auto messageObj = choices[0].toObject()["message"].toObject();
-    auto contentStr = messageObj["content"].toString();
-    auto contentDoc = QJsonDocument::fromJson(contentStr.toUtf8());
-    if (!contentDoc.isObject()) {
-        emit errorOccurred("Failed to parse structured JSON.");
-        reply->deleteLater();
+}
+
+void OpenAICommunicator::handleUsage(qint64 promptTokens, qint64, qint64 cachedTokens) {
+    if (promptTokens > 0) {
+        qDebug() << "Prompt cache:" << cachedTokens << "of" << promptTokens << "prompt tokens cached for" << effectiveModelName();
+    }
+}
+
+void OpenAICommunicator::handleCompleted(qint64 elapsedMs, bool success, bool hedgeWon) {
+    if (!modelStats) {
         return;
     }
-    auto result = contentDoc.object();
-    auto translation = result["translation"].toString();
-    emit replyReceived(translation);
-    reply->deleteLater();
-} 
+    auto model = effectiveModelName();
+    modelStats->recordCompletion(model, elapsedMs, success);
+    if (hedgeWon) {
+        modelStats->recordHedgeWon(model);
+        qDebug() << "Hedge won for" << model << "-" << modelStats->hedgesWon(model) << "of"
+                 << modelStats->hedgesIssued(model) << "hedges won so far";
+    }
+}
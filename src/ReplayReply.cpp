@@ -0,0 +1,82 @@
+#include "ReplayReply.h"
+#include <QTimer>
+#include <cstring>
+
+ReplayReply::ReplayReply(const QNetworkRequest &request, int statusCode, QNetworkReply::NetworkError errorCode,
+                         const QString &errorString, const QList<RecordedChunk> &chunks_, double speed_,
+                         QObject *parent)
+    : QNetworkReply(parent)
+    , chunks(chunks_)
+    , nextChunk(0)
+    , readOffset(0)
+    , recordedError(errorCode)
+    , recordedErrorString(errorString)
+    , speed(speed_)
+{
+    setRequest(request);
+    setUrl(request.url());
+    setOperation(QNetworkAccessManager::PostOperation);
+    if (statusCode > 0) {
+        setAttribute(QNetworkRequest::HttpStatusCodeAttribute, statusCode);
+    }
+    open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    clock.start();
+    // Callers connect to the reply after post() returns, so nothing may be emitted before that
+    QTimer::singleShot(0, this, &ReplayReply::deliverNext);
+}
+
+void ReplayReply::deliverNext() {
+    if (isFinished()) {
+        return;
+    }
+    if (nextChunk < chunks.size()) {
+        const RecordedChunk &chunk = chunks[nextChunk];
+        if (speed > 0) {
+            qint64 delay = static_cast<qint64>(chunk.atMs / speed) - clock.elapsed();
+            if (delay > 0) {
+                QTimer::singleShot(static_cast<int>(delay), this, &ReplayReply::deliverNext);
+                return;
+            }
+        }
+        buffer.append(chunk.data);
+        nextChunk++;
+        emit readyRead();
+        QTimer::singleShot(0, this, &ReplayReply::deliverNext);
+        return;
+    }
+    finish(recordedError, recordedErrorString);
+}
+
+void ReplayReply::finish(QNetworkReply::NetworkError code, const QString &message) {
+    if (code != QNetworkReply::NoError) {
+        setError(code, message);
+        emit errorOccurred(code);
+    }
+    setFinished(true);
+    emit finished();
+}
+
+void ReplayReply::abort() {
+    if (isFinished()) {
+        return;
+    }
+    finish(QNetworkReply::OperationCanceledError, "Operation canceled");
+}
+
+qint64 ReplayReply::bytesAvailable() const {
+    return buffer.size() - readOffset + QIODevice::bytesAvailable();
+}
+
+bool ReplayReply::isSequential() const {
+    return true;
+}
+
+qint64 ReplayReply::readData(char *data, qint64 maxSize) {
+    qint64 count = qMin(maxSize, static_cast<qint64>(buffer.size()) - readOffset);
+    if (count <= 0) {
+        return isFinished() ? -1 : 0;
+    }
+    std::memcpy(data, buffer.constData() + readOffset, static_cast<size_t>(count));
+    readOffset += count;
+    return count;
+}
@@ -0,0 +1,247 @@
+#include "ReportBatch.h"
+#include "AppDataManager.h"
+#include "SettingsManager.h"
+#include "OpenAICommunicator.h"
+#include "RequestWorker.h"
+#include "MistakeStore.h"
+#include "ExchangeRecorder.h"
+#include <QNetworkReply>
+#include <QHttpMultiPart>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QDebug>
+
+// Batches usually take minutes to hours, so frequent polling gains nothing
+const int POLL_INTERVAL_MS = 60 * 1000;
+const QString BATCH_ENDPOINT = "/v1/chat/completions";
+
+ReportBatch::ReportBatch(AppDataManager *appDataManager_, SettingsManager *settingsManager_, QObject *parent)
+    : QObject(parent)
+    , appDataManager(appDataManager_)
+    , settingsManager(settingsManager_)
+    , networkManager(new QNetworkAccessManager(this))
+    , pollTimer(new QTimer(this))
+    , batchId(settingsManager_->reportBatchId())
+    , batchDays(settingsManager_->reportBatchDays())
+    , busy(false)
+{
+    pollTimer->setInterval(POLL_INTERVAL_MS);
+    pollTimer->setTimerType(Qt::VeryCoarseTimer);
+    connect(pollTimer, &QTimer::timeout, this, &ReportBatch::poll);
+}
+
+void ReportBatch::setApiKey(const QString &apiKey_) {
+    apiKey = apiKey_;
+    // A batch submitted before the last exit is picked up again
+    if (!apiKey.isEmpty() && !batchId.isEmpty() && !pollTimer->isActive() && !ExchangeRecorder::isOffline()) {
+        qDebug() << "Resuming report batch" << batchId;
+        pollTimer->start();
+        QTimer::singleShot(0, this, &ReportBatch::poll);
+    }
+}
+
+bool ReportBatch::isRunning() const {
+    return busy || !batchId.isEmpty();
+}
+
+bool ReportBatch::isPending(const QString &dateString) const {
+    return isRunning() && batchDays.contains(dateString);
+}
+
+QNetworkRequest ReportBatch::apiRequest(const QString &path) const {
+    QNetworkRequest request(QUrl(OpenAICommunicator::defaultBaseUrl() + path));
+    request.setRawHeader("Authorization", ("Bearer " + apiKey).toUtf8());
+    return request;
+}
+
+QByteArray ReportBatch::buildInputFile(const QStringList &dateStrings, int *requestCount) const {
+    QByteArray jsonl;
+    *requestCount = 0;
+    QString prompt = settingsManager->reportPrompt().replace("%sourceLang", settingsManager->sourceLang());
+    for (const QString &dateString : dateStrings) {
+        QString fileContent = appDataManager->getFileContentForDate(dateString);
+        if (fileContent.isEmpty()) {
+            continue;
+        }
+        RequestSpec spec;
+        spec.modelName = settingsManager->reportModelName();
+        spec.prompt = prompt;
+        spec.inputText = fileContent;
+        spec.responseFormat = ResponseFormat::MistakeReport;
+        QJsonObject line{
+            {"custom_id", dateString},
+            {"method", "POST"},
+            {"url", BATCH_ENDPOINT},
+            {"body", RequestWorker::requestJson(spec)},
+        };
+        jsonl += QJsonDocument(line).toJson(QJsonDocument::Compact) + "\n";
+        (*requestCount)++;
+    }
+    return jsonl;
+}
+
+void ReportBatch::submit(const QStringList &dateStrings) {
+    if (isRunning()) {
+        emit errorOccurred("A report batch is already running.");
+        return;
+    }
+    // Batch jobs talk to the files and batches endpoints, which replay fixtures don't cover
+    if (ExchangeRecorder::isOffline()) {
+        emit errorOccurred("Batch reports are not available while replaying recorded exchanges.");
+        return;
+    }
+    int requestCount = 0;
+    QByteArray jsonl = buildInputFile(dateStrings, &requestCount);
+    if (requestCount == 0) {
+        emit errorOccurred("None of the selected days has any logged text.");
+        return;
+    }
+    busy = true;
+    batchDays = dateStrings;
+
+    auto multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+    QHttpPart purposePart;
+    purposePart.setHeader(QNetworkRequest::ContentDispositionHeader, "form-data; name=\"purpose\"");
+    purposePart.setBody("batch");
+    QHttpPart filePart;
+    filePart.setHeader(QNetworkRequest::ContentDispositionHeader, "form-data; name=\"file\"; filename=\"reports.jsonl\"");
+    filePart.setHeader(QNetworkRequest::ContentTypeHeader, "application/jsonl");
+    filePart.setBody(jsonl);
+    multiPart->append(purposePart);
+    multiPart->append(filePart);
+
+    auto reply = networkManager->post(apiRequest("/files"), multiPart);
+    multiPart->setParent(reply);
+    connect(reply, &QNetworkReply::finished, this, [=]() {
+        reply->deleteLater();
+        QJsonObject file = QJsonDocument::fromJson(reply->readAll()).object();
+        if (reply->error() != QNetworkReply::NoError || file["id"].toString().isEmpty()) {
+            fail("Uploading the batch file failed: " + reply->errorString());
+            return;
+        }
+        qDebug() << "Uploaded" << requestCount << "report requests as" << file["id"].toString();
+        createBatch(file["id"].toString());
+        emit submitted(requestCount);
+    });
+}
+
+void ReportBatch::createBatch(const QString &inputFileId) {
+    QNetworkRequest request = apiRequest("/batches");
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    QJsonObject body{
+        {"input_file_id", inputFileId},
+        {"endpoint", BATCH_ENDPOINT},
+        {"completion_window", "24h"},
+    };
+    auto reply = networkManager->post(request, QJsonDocument(body).toJson());
+    connect(reply, &QNetworkReply::finished, this, [=]() {
+        reply->deleteLater();
+        QJsonObject batch = QJsonDocument::fromJson(reply->readAll()).object();
+        if (reply->error() != QNetworkReply::NoError || batch["id"].toString().isEmpty()) {
+            fail("Creating the batch failed: " + reply->errorString());
+            return;
+        }
+        busy = false;
+        setBatchId(batch["id"].toString());
+        pollTimer->start();
+    });
+}
+
+void ReportBatch::poll() {
+    if (batchId.isEmpty() || busy) {
+        return;
+    }
+    busy = true;
+    auto reply = networkManager->get(apiRequest("/batches/" + batchId));
+    connect(reply, &QNetworkReply::finished, this, [=]() {
+        reply->deleteLater();
+        busy = false;
+        if (reply->error() != QNetworkReply::NoError) {
+            // Transient network errors are retried on the next tick, an unknown batch is dropped
+            int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            if (status == 404) {
+                fail("The report batch " + batchId + " no longer exists.");
+            }
+            return;
+        }
+        QJsonObject batch = QJsonDocument::fromJson(reply->readAll()).object();
+        QString status = batch["status"].toString();
+        int failedCount = batch["request_counts"].toObject()["failed"].toInt();
+        if (status == "completed" || status == "expired" || status == "cancelled") {
+            // Expired and cancelled batches still deliver the requests that did finish
+            pollTimer->stop();
+            downloadResults(batch["output_file_id"].toString(), failedCount);
+        } else if (status == "failed") {
+            QJsonArray errors = batch["errors"].toObject()["data"].toArray();
+            fail("The report batch failed: " + (errors.isEmpty() ? status : errors.first().toObject()["message"].toString()));
+        }
+    });
+}
+
+void ReportBatch::downloadResults(const QString &outputFileId, int failedCount) {
+    if (outputFileId.isEmpty()) {
+        setBatchId("");
+        emit finished(0, failedCount);
+        return;
+    }
+    busy = true;
+    auto reply = networkManager->get(apiRequest("/files/" + outputFileId + "/content"));
+    connect(reply, &QNetworkReply::finished, this, [=]() {
+        reply->deleteLater();
+        busy = false;
+        if (reply->error() != QNetworkReply::NoError) {
+            // Keep the batch id, the download is tried again on the next tick
+            pollTimer->start();
+            return;
+        }
+        QByteArray jsonl = reply->readAll();
+        int written = writeResults(jsonl);
+        int lines = jsonl.count('\n') + (jsonl.endsWith('\n') ? 0 : 1);
+        setBatchId("");
+        emit finished(written, failedCount + qMax(0, lines - written));
+    });
+}
+
+int ReportBatch::writeResults(const QByteArray &jsonl) {
+    int written = 0;
+    for (const QByteArray &line : jsonl.split('\n')) {
+        if (line.trimmed().isEmpty()) {
+            continue;
+        }
+        QJsonObject result = QJsonDocument::fromJson(line).object();
+        QString dateString = result["custom_id"].toString();
+        QJsonObject response = result["response"].toObject();
+        if (dateString.isEmpty() || response["status_code"].toInt() != 200) {
+            qDebug() << "Batch report for" << dateString << "failed:" << result["error"].toObject()["message"].toString();
+            continue;
+        }
+        QString content = response["body"].toObject()["choices"].toArray().at(0).toObject()["message"].toObject()["content"].toString();
+        QJsonObject report = QJsonDocument::fromJson(content.toUtf8()).object();
+        if (!report["mistakes"].isArray()) {
+            qDebug() << "Batch report for" << dateString << "has no mistakes list";
+            continue;
+        }
+        appDataManager->writeMistakesReport(MistakeStore::recordsFromJson(report["mistakes"].toArray()), dateString, false);
+        written++;
+        emit reportReady(dateString);
+    }
+    return written;
+}
+
+void ReportBatch::setBatchId(const QString &batchId_) {
+    batchId = batchId_;
+    if (batchId.isEmpty()) {
+        batchDays.clear();
+    }
+    settingsManager->setReportBatchId(batchId);
+    settingsManager->setReportBatchDays(batchDays);
+    settingsManager->sync();
+}
+
+void ReportBatch::fail(const QString &errorString) {
+    busy = false;
+    pollTimer->stop();
+    setBatchId("");
+    emit errorOccurred(errorString);
+}
@@ -0,0 +1,155 @@
+#include "ReportScheduler.h"
+#include "AppDataManager.h"
+#include "SettingsManager.h"
+#include "ReportBatch.h"
+#include "OpenAICommunicator.h"
+#include "ModelRouter.h"
+#include <QCoreApplication>
+#include <QEvent>
+#include <QTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QDebug>
+
+const int TICK_INTERVAL_MS = 60 * 1000;
+// How long without keyboard or mouse input before the user counts as away
+const qint64 IDLE_AFTER_MS = 5 * 60 * 1000;
+const int MAX_CONCURRENT_REPORTS = 2;
+// Only the days the Generate Report menu offers are worth preparing
+const int LOOKBACK_DAYS = 10;
+
+ReportScheduler::ReportScheduler(AppDataManager *appDataManager_, SettingsManager *settingsManager_, QObject *parent)
+    : QObject(parent)
+    , appDataManager(appDataManager_)
+    , settingsManager(settingsManager_)
+    , reportBatch(nullptr)
+    , timer(new QTimer(this))
+{
+    timer->setInterval(TICK_INTERVAL_MS);
+    timer->setTimerType(Qt::VeryCoarseTimer);
+    connect(timer, &QTimer::timeout, this, &ReportScheduler::tick);
+    sinceLastInput.start();
+}
+
+void ReportScheduler::setApiKey(const QString &apiKey_) {
+    apiKey = apiKey_;
+}
+
+void ReportScheduler::setEnabled(bool enabled) {
+    if (enabled == timer->isActive()) {
+        return;
+    }
+    if (enabled) {
+        qApp->installEventFilter(this);
+        sinceLastInput.restart();
+        timer->start();
+    } else {
+        qApp->removeEventFilter(this);
+        timer->stop();
+    }
+}
+
+void ReportScheduler::setReportBatch(ReportBatch *reportBatch_) {
+    reportBatch = reportBatch_;
+}
+
+bool ReportScheduler::isPending(const QString &dateString) const {
+    return inFlight.contains(dateString);
+}
+
+bool ReportScheduler::eventFilter(QObject *watched, QEvent *event) {
+    switch (event->type()) {
+        case QEvent::KeyPress:
+        case QEvent::MouseButtonPress:
+        case QEvent::MouseMove:
+        case QEvent::Wheel:
+            sinceLastInput.restart();
+            break;
+        default:
+            break;
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+bool ReportScheduler::shouldRun() {
+    if (sinceLastInput.elapsed() >= IDLE_AFTER_MS) {
+        return true;
+    }
+    QTime scheduledTime = QTime::fromString(settingsManager->precomputeReportsTime(), "HH:mm");
+    // Stays open until tick() finds nothing left to prepare
+    return scheduledTime.isValid() && lastScheduledRun != QDate::currentDate() && QTime::currentTime() >= scheduledTime;
+}
+
+QStringList ReportScheduler::daysWithoutReport() const {
+    QStringList days;
+    QDate today = QDate::currentDate();
+    // Today is still being written to, so only finished days qualify
+    for (int i = 1; i <= LOOKBACK_DAYS; ++i) {
+        QString dateString = today.addDays(-i).toString("yyyy-MM-dd");
+        if (inFlight.contains(dateString) || failedDays.contains(dateString)
+            || (reportBatch && reportBatch->isPending(dateString))) {
+            continue;
+        }
+        if (QFile::exists(AppDataManager::getAppDataPath() + "/" + dateString + ".txt")
+            && !appDataManager->hasUpToDateReport(dateString)) {
+            days.append(dateString);
+        }
+    }
+    return days;
+}
+
+void ReportScheduler::tick() {
+    if (apiKey.isEmpty() || inFlight.size() >= MAX_CONCURRENT_REPORTS || !shouldRun()) {
+        return;
+    }
+    QDate today = QDate::currentDate();
+    int budget = settingsManager->precomputeReportsTokenBudget();
+    // At most one new request per tick keeps background work from competing with translations
+    for (const QString &dateString : daysWithoutReport()) {
+        QString fileContent = appDataManager->getFileContentForDate(dateString);
+        if (fileContent.isEmpty()) {
+            continue;
+        }
+        int estimatedTokens = ModelRouter::estimateTokens(fileContent);
+        int spent = settingsManager->precomputeReportsTokensSpent(today);
+        if (spent + estimatedTokens > budget) {
+            qDebug() << "Skipping background report for" << dateString << "- daily token budget reached";
+            continue;
+        }
+        settingsManager->setPrecomputeReportsTokensSpent(today, spent + estimatedTokens);
+        generate(dateString, fileContent, estimatedTokens);
+        return;
+    }
+    // Every day is done or over budget, so the scheduled run is over for today
+    if (inFlight.isEmpty()) {
+        lastScheduledRun = today;
+    }
+}
+
+void ReportScheduler::generate(const QString &dateString, const QString &fileContent, int estimatedTokens) {
+    qDebug() << "Generating report for" << dateString << "in the background (~" << estimatedTokens << "tokens)";
+    inFlight.insert(dateString);
+    auto communicator = new OpenAICommunicator(apiKey, this);
+    QString prompt = settingsManager->reportPrompt().replace("%sourceLang", settingsManager->sourceLang());
+    communicator->setModelName(settingsManager->reportModelName());
+    communicator->setPromptRaw(prompt);
+    communicator->setInputText(fileContent);
+    communicator->setResponseFormat(ResponseFormat::MistakeReport);
+    communicator->setTask(Metrics::TaskReport);
+    communicator->setPriority(RequestScheduler::PriorityBackground);
+
+    connect(communicator, &OpenAICommunicator::structuredReplyReceived, this, [=](const QJsonObject &result) {
+        inFlight.remove(dateString);
+        appDataManager->writeMistakesReport(MistakeStore::recordsFromJson(result["mistakes"].toArray()), dateString, false);
+        communicator->deleteLater();
+        emit reportReady(dateString);
+    });
+    connect(communicator, &OpenAICommunicator::errorOccurred, this, [=](const QString &errorString) {
+        inFlight.remove(dateString);
+        // Not retried until the next start, so a broken day can't drain the budget
+        failedDays.insert(dateString);
+        qDebug() << "Background report for" << dateString << "failed:" << errorString;
+        communicator->deleteLater();
+    });
+    communicator->sendRequest();
+}
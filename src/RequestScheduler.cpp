@@ -0,0 +1,111 @@
+#include "RequestScheduler.h"
+#include <QDebug>
+
+// Per-class limits on requests in flight
+const std::array<int, RequestScheduler::PriorityCount> CLASS_LIMITS{4, 2, 1, 1};
+// Limit for everything except interactive requests, which are never held back
+const int MAX_NON_INTERACTIVE = 3;
+// A request that has waited this long starts as soon as its own class has room
+const qint64 STARVATION_MS = 20000;
+const int AGING_CHECK_INTERVAL_MS = 1000;
+
+RequestScheduler &RequestScheduler::instance() {
+    static RequestScheduler scheduler;
+    return scheduler;
+}
+
+RequestScheduler::RequestScheduler(QObject *parent)
+    : QObject(parent)
+    , agingTimer(new QTimer(this))
+{
+    agingTimer->setInterval(AGING_CHECK_INTERVAL_MS);
+    connect(agingTimer, &QTimer::timeout, this, &RequestScheduler::dispatch);
+}
+
+void RequestScheduler::submit(Priority priority, QObject *owner, const std::function<QObject*()> &create) {
+    Pending pending{owner, create, QElapsedTimer()};
+    pending.waiting.start();
+    queues[priority].enqueue(pending);
+    dispatch();
+}
+
+int RequestScheduler::queuedCount(Priority priority) const {
+    return queues[priority].size();
+}
+
+int RequestScheduler::runningCount(Priority priority) const {
+    return running[priority];
+}
+
+bool RequestScheduler::canStart(int priority, bool starving) const {
+    if (running[priority] >= CLASS_LIMITS[priority]) {
+        return false;
+    }
+    if (priority == PriorityInteractive || starving) {
+        return true;
+    }
+    int nonInteractive = 0;
+    for (int p = PriorityFeedback; p < PriorityCount; ++p) {
+        nonInteractive += running[p];
+    }
+    if (nonInteractive >= MAX_NON_INTERACTIVE) {
+        return false;
+    }
+    // Large uploads would compete with a translation for bandwidth and the rate limit
+    bool interactiveBusy = running[PriorityInteractive] > 0 || !queues[PriorityInteractive].isEmpty();
+    return !(interactiveBusy && priority >= PriorityReport);
+}
+
+void RequestScheduler::dispatch() {
+    while (true) {
+        int chosen = -1;
+        // Requests that waited too long go first, so background work can't starve forever
+        for (int p = 0; p < PriorityCount && chosen < 0; ++p) {
+            if (!queues[p].isEmpty() && queues[p].head().waiting.elapsed() >= STARVATION_MS && canStart(p, true)) {
+                chosen = p;
+            }
+        }
+        for (int p = 0; p < PriorityCount && chosen < 0; ++p) {
+            if (!queues[p].isEmpty() && canStart(p, false)) {
+                chosen = p;
+            }
+        }
+        if (chosen < 0) {
+            break;
+        }
+        Pending pending = queues[chosen].dequeue();
+        if (!pending.owner) {
+            continue;
+        }
+        if (pending.waiting.elapsed() >= AGING_CHECK_INTERVAL_MS) {
+            qDebug() << "Starting queued request of class" << chosen << "after" << pending.waiting.elapsed() << "ms";
+        }
+        running[chosen]++;
+        QObject *request = pending.create();
+        if (!request) {
+            running[chosen]--;
+            continue;
+        }
+        // Connected before the request starts, since a fast reply can delete it right away.
+        // Emitted from whichever thread the request lives on, so this is queued back to us
+        connect(request, &QObject::destroyed, this, [this, chosen]() {
+            release(chosen);
+        });
+        QMetaObject::invokeMethod(request, "start", Qt::QueuedConnection);
+    }
+
+    bool anyQueued = false;
+    for (const auto &queue : queues) {
+        anyQueued = anyQueued || !queue.isEmpty();
+    }
+    if (anyQueued && !agingTimer->isActive()) {
+        agingTimer->start();
+    } else if (!anyQueued) {
+        agingTimer->stop();
+    }
+}
+
+void RequestScheduler::release(int priority) {
+    running[priority]--;
+    dispatch();
+}
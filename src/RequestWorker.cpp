@@ -0,0 +1,347 @@
+#include "RequestWorker.h"
+#include "Tracer.h"
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDebug>
+
+// A reply that stays silent this long is aborted, so every request eventually finishes
+const int TRANSFER_TIMEOUT_MS = 120000;
+
+RequestWorker::RequestWorker(const RequestSpec &spec_, QObject *parent)
+    : QObject(parent)
+    , spec(spec_)
+    , hedgeTimer(new QTimer(this))
+    , firstByteSeen(false)
+    , firstTokenSeen(false)
+    , done(false)
+{
+    hedgeTimer->setSingleShot(true);
+    connect(hedgeTimer, &QTimer::timeout, this, &RequestWorker::sendHedgeRequest);
+}
+
+QJsonObject RequestWorker::responseSchema(ResponseFormat responseFormat) {
+    auto schema = QJsonObject{};
+    schema["type"] = "object";
+    schema["additionalProperties"] = false;
+    switch (responseFormat) {
+        case ResponseFormat::SegmentedTranslation:
+            schema["properties"] = QJsonObject{
+                {"translations", QJsonObject{{"type", "array"}, {"items", QJsonObject{{"type", "string"}}}}},
+            };
+            schema["required"] = QJsonArray{"translations"};
+            return QJsonObject{{"name", "segmented_translation_response"}, {"strict", true}, {"schema", schema}};
+        case ResponseFormat::SentenceFeedback:
+            schema["properties"] = QJsonObject{
+                {"feedback", QJsonObject{{"type", "array"}, {"items", QJsonObject{{"type", "string"}}}}},
+            };
+            schema["required"] = QJsonArray{"feedback"};
+            return QJsonObject{{"name", "sentence_feedback_response"}, {"strict", true}, {"schema", schema}};
+        case ResponseFormat::MistakeReport: {
+            auto mistake = QJsonObject{
+                {"type", "object"},
+                {"additionalProperties", false},
+                {"properties", QJsonObject{
+                    {"original", QJsonObject{{"type", "string"}}},
+                    {"corrected", QJsonObject{{"type", "string"}}},
+                    {"explanation", QJsonObject{{"type", "string"}}},
+                    {"category", QJsonObject{
+                        {"type", "string"},
+                        {"enum", QJsonArray{"spelling", "grammar", "verb form", "agreement", "word order",
+                                            "word choice", "preposition", "article", "punctuation", "other"}}
+                    }},
+                }},
+                {"required", QJsonArray{"original", "corrected", "explanation", "category"}},
+            };
+            schema["properties"] = QJsonObject{
+                {"mistakes", QJsonObject{{"type", "array"}, {"items", mistake}}},
+            };
+            schema["required"] = QJsonArray{"mistakes"};
+            return QJsonObject{{"name", "mistake_report_response"}, {"strict", true}, {"schema", schema}};
+        }
+        case ResponseFormat::Translation:
+        default:
+            schema["properties"] = QJsonObject{
+                {"translation", QJsonObject{{"type", "string"}}},
+            };
+            schema["required"] = QJsonArray{"translation"};
+            return QJsonObject{{"name", "translation_response"}, {"strict", true}, {"schema", schema}};
+    }
+}
+
+QByteArray RequestWorker::buildBody() const {
+    TRACE_SCOPE("request.build_body");
+    return QJsonDocument(requestJson(spec)).toJson();
+}
+
+QJsonObject RequestWorker::requestJson(const RequestSpec &spec) {
+    auto json = QJsonObject{};
+    json["model"] = spec.modelName;
+
+    bool segmented = spec.responseFormat == ResponseFormat::SegmentedTranslation
+                     || spec.responseFormat == ResponseFormat::SentenceFeedback;
+    // Static instructions first and everything that varies after them, so providers can
+    // reuse the cached prefix across requests
+    auto messages = QJsonArray{};
+    auto message = QJsonObject{};
+    message["role"] = "system";
+    if (spec.responseFormat == ResponseFormat::SegmentedTranslation) {
+        message["content"] = spec.prompt + "\n\nThe input is a JSON array of sentences. Return a \"translations\" array with exactly one translation per input item, in the same order.";
+    } else if (spec.responseFormat == ResponseFormat::SentenceFeedback) {
+        message["content"] = spec.prompt + "\n\nThe input is a JSON array of sentences. Return a \"feedback\" array with exactly one entry per input item, in the same order, using an empty string for sentences that need no comment.";
+    } else {
+        message["content"] = spec.prompt;
+    }
+    messages.append(message);
+    if (!spec.context.isEmpty()) {
+        messages.append(QJsonObject{{"role", "user"}, {"content", spec.context}});
+    }
+    messages.append(QJsonObject{
+        {"role", "user"},
+        {"content", segmented
+            ? QString::fromUtf8(QJsonDocument(QJsonArray::fromStringList(spec.segments)).toJson(QJsonDocument::Compact))
+            : spec.inputText}
+    });
+    json["messages"] = messages;
+
+    json["response_format"] = QJsonObject{
+        {"type", "json_schema"},
+        {"json_schema", responseSchema(spec.responseFormat)}
+    };
+    if (spec.stream) {
+        json["stream"] = true;
+        json["stream_options"] = QJsonObject{{"include_usage", true}};
+    }
+    return json;
+}
+
+void RequestWorker::start() {
+    request = QNetworkRequest(QUrl(spec.baseUrl + "/chat/completions"));
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    request.setRawHeader("Authorization", ("Bearer " + spec.apiKey).toUtf8());
+    request.setTransferTimeout(TRANSFER_TIMEOUT_MS);
+    body = buildBody();
+
+    requestTimer.start();
+    Tracer::asyncBegin("request.network", reinterpret_cast<quintptr>(this), spec.modelName);
+    Tracer::asyncBegin("request.waiting_first_byte", reinterpret_cast<quintptr>(this));
+    Metrics::instance().recordRequest(spec.task, spec.modelName);
+    postRequest(false);
+    if (spec.hedgeDelayMs >= 0) {
+        hedgeTimer->start(static_cast<int>(spec.hedgeDelayMs));
+    }
+}
+
+void RequestWorker::abort() {
+    if (done) {
+        return;
+    }
+    done = true;
+    hedgeTimer->stop();
+    const auto replies = activeReplies;
+    activeReplies.clear();
+    for (auto reply : replies) {
+        reply->abort();
+    }
+    if (!firstByteSeen) {
+        Tracer::asyncEnd("request.waiting_first_byte", reinterpret_cast<quintptr>(this));
+    }
+    Tracer::asyncEnd("request.network", reinterpret_cast<quintptr>(this));
+    deleteLater();
+}
+
+void RequestWorker::postRequest(bool isHedge) {
+    auto reply = ExchangeRecorder::post(request, body);
+    reply->setProperty("isHedge", isHedge);
+    reply->setProperty("startedAtMs", requestTimer.elapsed());
+    connect(reply, &QNetworkReply::readyRead, this, &RequestWorker::handleReadyRead);
+    connect(reply, &QNetworkReply::finished, this, &RequestWorker::handleFinished);
+    activeReplies.append(reply);
+}
+
+void RequestWorker::handleReadyRead() {
+    auto reply = qobject_cast<QNetworkReply*>(sender());
+    if (!reply) {
+        return;
+    }
+    auto chunk = reply->readAll();
+    ReplyData &received = replyData[reply];
+    received.data.append(chunk);
+    if (ExchangeRecorder::isRecording()) {
+        received.chunks.append(RecordedChunk{requestTimer.elapsed() - reply->property("startedAtMs").toLongLong(), chunk});
+    }
+    if (spec.stream && !firstTokenSeen) {
+        auto partial = streamedResponse(received.data);
+        if (!partial["choices"].toArray().at(0).toObject()["message"].toObject()["content"].toString().isEmpty()) {
+            firstTokenSeen = true;
+            emit firstTokenReceived(requestTimer.elapsed() - reply->property("startedAtMs").toLongLong());
+        }
+    }
+    if (reply->property("firstByteSeen").toBool()) {
+        return;
+    }
+    reply->setProperty("firstByteSeen", true);
+    if (!firstByteSeen) {
+        firstByteSeen = true;
+        hedgeTimer->stop();
+        Tracer::asyncEnd("request.waiting_first_byte", reinterpret_cast<quintptr>(this));
+        Metrics::instance().recordLatency(spec.task, Metrics::HistogramFirstByte, requestTimer.elapsed());
+    }
+    emit firstByteReceived(requestTimer.elapsed() - reply->property("startedAtMs").toLongLong());
+}
+
+void RequestWorker::sendHedgeRequest() {
+    if (done || firstByteSeen || activeReplies.size() != 1) {
+        return;
+    }
+    qDebug() << "No first byte from" << spec.modelName << "after" << requestTimer.elapsed() << "ms, sending hedge request";
+    emit hedgeIssued();
+    postRequest(true);
+}
+
+void RequestWorker::handleFinished() {
+    auto reply = qobject_cast<QNetworkReply*>(sender());
+    if (!reply) {
+        return;
+    }
+    activeReplies.removeAll(reply);
+    reply->deleteLater();
+    ReplyData received = replyData.take(reply);
+    if (done) {
+        // The losing side of a hedged pair, already aborted
+        return;
+    }
+    if (reply->error() != QNetworkReply::NoError && !activeReplies.isEmpty()) {
+        // The other copy of this request may still succeed
+        qDebug() << "Hedged request failed, waiting for the remaining one:" << reply->errorString();
+        return;
+    }
+    done = true;
+    hedgeTimer->stop();
+    const auto losers = activeReplies;
+    activeReplies.clear();
+    for (auto loser : losers) {
+        loser->abort();
+    }
+    bool success = reply->error() == QNetworkReply::NoError;
+    if (!firstByteSeen) {
+        Tracer::asyncEnd("request.waiting_first_byte", reinterpret_cast<quintptr>(this));
+    }
+    Tracer::asyncEnd("request.network", reinterpret_cast<quintptr>(this));
+    emit completed(requestTimer.elapsed(), success, reply->property("isHedge").toBool());
+    Metrics::instance().recordLatency(spec.task, Metrics::HistogramRequestLatency, requestTimer.elapsed());
+
+    auto rest = reply->readAll();
+    if (!rest.isEmpty()) {
+        received.data.append(rest);
+        if (ExchangeRecorder::isRecording()) {
+            received.chunks.append(RecordedChunk{requestTimer.elapsed() - reply->property("startedAtMs").toLongLong(), rest});
+        }
+    }
+    ExchangeRecorder::save(request, body, reply, received.chunks);
+    auto responseData = received.data;
+    qDebug() << responseData;
+    if (!success) {
+        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        Metrics::ErrorClass errorClass = Metrics::ErrorNetwork;
+        if (status == 429) {
+            errorClass = Metrics::ErrorRateLimit;
+        } else if (status >= 500) {
+            errorClass = Metrics::ErrorServer;
+        } else if (status >= 400) {
+            errorClass = Metrics::ErrorClient;
+        } else if (reply->error() == QNetworkReply::TimeoutError || reply->error() == QNetworkReply::OperationCanceledError) {
+            errorClass = Metrics::ErrorTimeout;
+        }
+        fail(errorClass, reply->errorString() + " " + responseData);
+    } else {
+        parseResponse(spec.stream ? streamedResponse(responseData) : QJsonDocument::fromJson(responseData).object());
+    }
+    deleteLater();
+}
+
+void RequestWorker::fail(Metrics::ErrorClass errorClass, const QString &errorString) {
+    Metrics::instance().recordError(spec.task, errorClass);
+    emit errorOccurred(errorString);
+}
+
+QJsonObject RequestWorker::streamedResponse(const QByteArray &data) {
+    // Server-sent events: one "data: {json}" line per delta, then "data: [DONE]"
+    QString content;
+    QJsonObject usage;
+    bool sawChoice = false;
+    for (const QByteArray &line : data.split('\n')) {
+        if (!line.startsWith("data:")) {
+            continue;
+        }
+        auto event = QJsonDocument::fromJson(line.mid(5).trimmed()).object();
+        auto choices = event["choices"].toArray();
+        if (!choices.isEmpty()) {
+            sawChoice = true;
+            content += choices[0].toObject()["delta"].toObject()["content"].toString();
+        }
+        if (event["usage"].isObject()) {
+            usage = event["usage"].toObject();
+        }
+    }
+    QJsonObject root{{"usage", usage}};
+    if (sawChoice) {
+        root["choices"] = QJsonArray{QJsonObject{{"message", QJsonObject{{"content", content}}}}};
+    }
+    return root;
+}
+
+void RequestWorker::parseResponse(const QJsonObject &root) {
+    TRACE_SCOPE("request.parse");
+    auto usage = root["usage"].toObject();
+    qint64 cachedTokens = usage["prompt_tokens_details"].toObject()["cached_tokens"].toInteger();
+    Metrics::instance().recordTokens(spec.task, usage["prompt_tokens"].toInteger(), usage["completion_tokens"].toInteger(), cachedTokens);
+    auto choices = root["choices"].toArray();
+    if (choices.isEmpty()) {
+        fail(Metrics::ErrorParse, "No choices returned.");
+        return;
+    }
+    auto messageObj = choices[0].toObject()["message"].toObject();
+    auto contentStr = messageObj["content"].toString();
+    emit usageReceived(usage["prompt_tokens"].toInteger(), usage["completion_tokens"].toInteger(), cachedTokens, contentStr.size());
+    auto contentDoc = QJsonDocument::fromJson(contentStr.toUtf8());
+    if (!contentDoc.isObject()) {
+        fail(Metrics::ErrorParse, "Failed to parse structured JSON.");
+        return;
+    }
+    auto result = contentDoc.object();
+    switch (spec.responseFormat) {
+        case ResponseFormat::MistakeReport:
+            emit structuredReplyReceived(result);
+            return;
+        case ResponseFormat::SegmentedTranslation: {
+            auto translations = result["translations"].toArray();
+            if (translations.size() != spec.segments.size()) {
+                fail(Metrics::ErrorParse, QString("Expected %1 translated segments, got %2.").arg(spec.segments.size()).arg(translations.size()));
+                return;
+            }
+            QStringList translatedSegments;
+            for (const auto &translation : translations) {
+                translatedSegments.append(translation.toString());
+            }
+            emit segmentsReceived(translatedSegments);
+            return;
+        }
+        case ResponseFormat::SentenceFeedback: {
+            auto feedback = result["feedback"].toArray();
+            if (feedback.size() != spec.segments.size()) {
+                fail(Metrics::ErrorParse, QString("Expected feedback for %1 sentences, got %2.").arg(spec.segments.size()).arg(feedback.size()));
+                return;
+            }
+            QStringList sentenceFeedback;
+            for (const auto &entry : feedback) {
+                sentenceFeedback.append(entry.toString());
+            }
+            emit segmentsReceived(sentenceFeedback);
+            return;
+        }
+        case ResponseFormat::Translation:
+        default:
+            emit replyReceived(result["translation"].toString());
+            return;
+    }
+}
@@ -0,0 +1,90 @@
+#include "SearchDialog.h"
+#include <QVBoxLayout>
+#include <QSplitter>
+#include <QElapsedTimer>
+#include <QLocale>
+#include <QUrl>
+
+SearchDialog::SearchDialog(SearchIndex *searchIndex_, QWidget *parent)
+    : QDialog(parent)
+    , searchIndex(searchIndex_)
+    , queryEdit(new QLineEdit(this))
+    , statusLabel(new QLabel(this))
+    , resultsView(new QTextBrowser(this))
+    , entryView(new QPlainTextEdit(this))
+{
+    setWindowTitle("Search Logs and Reports");
+    setAttribute(Qt::WA_DeleteOnClose);
+    resize(700, 550);
+
+    queryEdit->setPlaceholderText("Search what you wrote and the mistakes found in it");
+    queryEdit->setClearButtonEnabled(true);
+    resultsView->setOpenLinks(false);
+    entryView->setReadOnly(true);
+
+    auto splitter = new QSplitter(Qt::Vertical, this);
+    splitter->addWidget(resultsView);
+    splitter->addWidget(entryView);
+    splitter->setStretchFactor(0, 3);
+    splitter->setStretchFactor(1, 1);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(queryEdit);
+    layout->addWidget(statusLabel);
+    layout->addWidget(splitter);
+
+    connect(queryEdit, &QLineEdit::textChanged, this, &SearchDialog::runSearch);
+    connect(resultsView, &QTextBrowser::anchorClicked, this, &SearchDialog::showHit);
+
+    connect(searchIndex, &SearchIndex::indexLoaded, this, [this]() {
+        statusLabel->setText(QString("%1 entries and reports").arg(searchIndex->documentCount()));
+        if (!queryEdit->text().trimmed().isEmpty()) {
+            runSearch();
+        }
+    });
+
+    // Building the index can take a moment after years of logs, so it happens in the background
+    if (searchIndex->isLoaded()) {
+        statusLabel->setText(QString("%1 entries and reports").arg(searchIndex->documentCount()));
+    } else {
+        statusLabel->setText("Indexing logs and reports...");
+        searchIndex->load();
+    }
+}
+
+void SearchDialog::runSearch()
+{
+    if (!searchIndex->isLoaded()) {
+        searchIndex->load();
+        statusLabel->setText("Still indexing, results follow shortly...");
+        return;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    hits = searchIndex->search(queryEdit->text());
+    qint64 elapsedMs = timer.elapsed();
+
+    QString html;
+    for (int i = 0; i < hits.size(); ++i) {
+        const SearchHit &hit = hits[i];
+        QString date = QLocale().toString(hit.date, QLocale::ShortFormat);
+        QString where = hit.isReport ? "report" : hit.time;
+        html += QString("<p><a href=\"hit:%1\">%2</a> <small>%3</small><br>%4</p>")
+                    .arg(i).arg(date, where, hit.snippet);
+    }
+    resultsView->setHtml(html);
+    entryView->clear();
+    if (queryEdit->text().trimmed().isEmpty()) {
+        statusLabel->clear();
+    } else {
+        statusLabel->setText(QString("%1 hits in %2 ms").arg(hits.size()).arg(elapsedMs));
+    }
+}
+
+void SearchDialog::showHit(const QUrl &url)
+{
+    int index = url.path().toInt();
+    if (index >= 0 && index < hits.size()) {
+        entryView->setPlainText(hits[index].text);
+    }
+}
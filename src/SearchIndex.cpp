@@ -0,0 +1,424 @@
+#include "SearchIndex.h"
+#include "AppDataManager.h"
+#include "LogArchive.h"
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QMap>
+#include <QSet>
+#include <QSaveFile>
+#include <QTextBoundaryFinder>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+const quint32 SEARCH_JOURNAL_MAGIC = 0x494d5346; // "IMSF"
+const quint32 SEARCH_JOURNAL_VERSION = 1;
+// BM25 parameters
+const double K1 = 1.2;
+const double B = 0.75;
+const int SNIPPET_CONTEXT_CHARS = 70;
+// A one letter prefix could otherwise pull in most of the vocabulary
+const int MAX_PREFIX_EXPANSIONS = 100;
+// Replaced reports stay in the journal until they make up this share of it
+const int MIN_REPLACED_FOR_COMPACTION = 20;
+const double COMPACTION_RATIO = 0.25;
+
+SearchIndex::SearchIndex(const QString &directoryPath_, const QString &archivePath_, QObject *parent)
+    : QObject(parent)
+    , journalPath(directoryPath_ + "/search-journal.dat")
+    , directoryPath(directoryPath_)
+    , archivePath(archivePath_)
+    , state(Unloaded)
+    , loader(new QFutureWatcher<Index>(this))
+{
+    connect(loader, &QFutureWatcher<Index>::finished, this, &SearchIndex::indexBuilt);
+}
+
+QStringList SearchIndex::tokenize(const QString &text) {
+    // Word boundaries follow Unicode rules; case folding keeps letters like æ, ø and å intact
+    QString normalized = text.normalized(QString::NormalizationForm_C);
+    QStringList tokens;
+    QTextBoundaryFinder finder(QTextBoundaryFinder::Word, normalized);
+    int start = 0;
+    while (finder.toNextBoundary() != -1) {
+        int end = finder.position();
+        if (finder.boundaryReasons() & QTextBoundaryFinder::EndOfItem) {
+            QString word = normalized.mid(start, end - start);
+            if (!word.isEmpty() && word.at(0).isLetterOrNumber()) {
+                tokens.append(word.toCaseFolded());
+            }
+        }
+        start = end;
+    }
+    return tokens;
+}
+
+void SearchIndex::addLogEntry(const QDate &date, const QString &time, const QString &text) {
+    Document document{date.toJulianDay(), time, false, false, 0, text.trimmed()};
+    if (document.text.isEmpty()) {
+        return;
+    }
+    addDocument(document);
+}
+
+void SearchIndex::setReport(const QDate &date, const QString &text) {
+    Document document{date.toJulianDay(), QString(), true, false, 0, text.trimmed()};
+    // The newest report of a day wins, both here and when the journal is read back
+    addDocument(document);
+}
+
+void SearchIndex::addDocument(const Document &document) {
+    // The worker reads, and may rewrite, the journal while the index is being built
+    if (state == Loading) {
+        pendingDocuments.append(document);
+        return;
+    }
+    addToJournal(document);
+    if (state == Loaded) {
+        data.add(document);
+    }
+}
+
+void SearchIndex::addToJournal(const Document &document) {
+    QDir().mkpath(directoryPath);
+    QFile file(journalPath);
+    bool isNew = !file.exists() || file.size() == 0;
+    // Without a journal the next load indexes all existing logs, which includes this document
+    if (isNew && state == Unloaded) {
+        return;
+    }
+    if (file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        QDataStream out(&file);
+        if (isNew) {
+            out << SEARCH_JOURNAL_MAGIC << SEARCH_JOURNAL_VERSION;
+        }
+        out << document.day << document.time << document.isReport << document.text;
+    }
+}
+
+void SearchIndex::Index::add(const Document &source, bool keepTermsSorted) {
+    Document document = source;
+    QStringList tokens = tokenize(document.text);
+    document.length = tokens.size();
+    int id = documents.size();
+    if (document.isReport) {
+        auto previous = reportByDay.constFind(document.day);
+        if (previous != reportByDay.constEnd()) {
+            documents[*previous].removed = true;
+            totalLength -= documents[*previous].length;
+            removedCount++;
+        }
+        reportByDay[document.day] = id;
+    }
+    QHash<QString, int> frequencies;
+    for (const QString &token : tokens) {
+        frequencies[token]++;
+    }
+    for (auto it = frequencies.constBegin(); it != frequencies.constEnd(); ++it) {
+        auto posting = postings.find(it.key());
+        if (posting == postings.end()) {
+            posting = postings.insert(it.key(), {});
+            if (keepTermsSorted) {
+                sortedTerms.insert(std::lower_bound(sortedTerms.begin(), sortedTerms.end(), it.key()), it.key());
+            } else {
+                sortedTerms.append(it.key());
+            }
+        }
+        posting->append(Posting{id, it.value()});
+    }
+    totalLength += document.length;
+    documents.append(document);
+}
+
+bool SearchIndex::Index::containsEntry(const Document &document) const {
+    // Day files are indexed in date order, so only the tail can hold the same day
+    for (int i = documents.size() - 1; i >= 0 && documents[i].day >= document.day; --i) {
+        const Document &candidate = documents[i];
+        if (!candidate.isReport && candidate.day == document.day && candidate.time == document.time && candidate.text == document.text) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SearchIndex::load() {
+    if (state != Unloaded) {
+        return;
+    }
+    state = Loading;
+    loader->setFuture(QtConcurrent::run(&SearchIndex::loadIndex, journalPath, directoryPath, archivePath));
+}
+
+bool SearchIndex::isLoaded() const {
+    return state == Loaded;
+}
+
+void SearchIndex::indexBuilt() {
+    data = loader->result();
+    loader->setFuture(QFuture<Index>());
+    state = Loaded;
+    const QList<Document> pending = pendingDocuments;
+    pendingDocuments.clear();
+    for (const Document &document : pending) {
+        // An entry written while the day files were read may already be in them
+        if (data.readFromLogs && !document.isReport && data.containsEntry(document)) {
+            continue;
+        }
+        addToJournal(document);
+        data.add(document);
+    }
+    emit indexLoaded();
+}
+
+SearchIndex::Index SearchIndex::loadIndex(const QString &journalPath, const QString &directoryPath, const QString &archivePath) {
+    QElapsedTimer timer;
+    timer.start();
+    Index index;
+    QFile file(journalPath);
+    if (!file.exists()) {
+        indexLogs(index, directoryPath, archivePath);
+        writeJournal(journalPath, index);
+        return index;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        return index;
+    }
+    QDataStream in(&file);
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if (magic != SEARCH_JOURNAL_MAGIC || version != SEARCH_JOURNAL_VERSION) {
+        file.close();
+        qDebug() << "Search journal has an unknown format, indexing the logs again:" << journalPath;
+        indexLogs(index, directoryPath, archivePath);
+        writeJournal(journalPath, index);
+        return index;
+    }
+    QList<Document> journal;
+    while (!in.atEnd() && in.status() == QDataStream::Ok) {
+        Document document{0, QString(), false, false, 0, QString()};
+        in >> document.day >> document.time >> document.isReport >> document.text;
+        if (in.status() == QDataStream::Ok) {
+            journal.append(document);
+        }
+    }
+    file.close();
+
+    // Reports that were replaced later in the journal are skipped instead of indexed and removed
+    QHash<qint32, int> newestReport;
+    for (int i = 0; i < journal.size(); ++i) {
+        if (journal[i].isReport) {
+            newestReport[journal[i].day] = i;
+        }
+    }
+    int replaced = 0;
+    for (int i = 0; i < journal.size(); ++i) {
+        if (journal[i].isReport && newestReport.value(journal[i].day) != i) {
+            replaced++;
+            continue;
+        }
+        index.add(journal[i], false);
+    }
+    std::sort(index.sortedTerms.begin(), index.sortedTerms.end());
+    if (replaced >= MIN_REPLACED_FOR_COMPACTION && replaced >= COMPACTION_RATIO * journal.size()) {
+        writeJournal(journalPath, index);
+        qDebug() << "Compacted the search journal, dropping" << replaced << "replaced reports";
+    }
+    qDebug() << "Indexed" << index.documents.size() << "documents for search in" << timer.elapsed() << "ms";
+    return index;
+}
+
+void SearchIndex::indexLogs(Index &index, const QString &directoryPath, const QString &archivePath) {
+    // Each archived or current file, keyed by name, so a day present in both is read once
+    QMap<QString, QByteArray> files;
+    LogArchive archive(archivePath);
+    for (const QString &month : archive.months()) {
+        for (const QString &member : archive.memberNames(month)) {
+            if (AppDataManager::parseDayFileName(member).isValid()) {
+                files[member] = archive.readMember(member);
+            }
+        }
+    }
+    const QFileInfoList current = QDir(directoryPath).entryInfoList({"*.txt"}, QDir::Files);
+    for (const QFileInfo &fileInfo : current) {
+        if (AppDataManager::parseDayFileName(fileInfo.fileName()).isValid()) {
+            QFile file(fileInfo.absoluteFilePath());
+            if (file.open(QIODevice::ReadOnly)) {
+                files[fileInfo.fileName()] = file.readAll();
+            }
+        }
+    }
+    for (auto it = files.constBegin(); it != files.constEnd(); ++it) {
+        bool isReport = false;
+        qint32 day = AppDataManager::parseDayFileName(it.key(), &isReport).toJulianDay();
+        QString content = QString::fromUtf8(it.value());
+        if (isReport) {
+            index.add(Document{day, QString(), true, false, 0, content.trimmed()}, false);
+            continue;
+        }
+        for (const LogEntry &entry : AppDataManager::splitLogEntries(content)) {
+            index.add(Document{day, entry.time, false, false, 0, entry.text}, false);
+        }
+    }
+    std::sort(index.sortedTerms.begin(), index.sortedTerms.end());
+    index.readFromLogs = true;
+    qDebug() << "Built the search index from" << files.size() << "log and report files";
+}
+
+void SearchIndex::writeJournal(const QString &journalPath, const Index &index) {
+    QDir().mkpath(QFileInfo(journalPath).absolutePath());
+    QSaveFile file(journalPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream out(&file);
+    out << SEARCH_JOURNAL_MAGIC << SEARCH_JOURNAL_VERSION;
+    for (const Document &document : index.documents) {
+        if (!document.removed) {
+            out << document.day << document.time << document.isReport << document.text;
+        }
+    }
+    file.commit();
+}
+
+QStringList SearchIndex::expand(const QString &term) const {
+    QStringList terms;
+    for (auto it = std::lower_bound(data.sortedTerms.begin(), data.sortedTerms.end(), term);
+         it != data.sortedTerms.end() && it->startsWith(term) && terms.size() < MAX_PREFIX_EXPANSIONS; ++it) {
+        terms.append(*it);
+    }
+    return terms;
+}
+
+QList<SearchHit> SearchIndex::search(const QString &query, int maxHits) {
+    if (state != Loaded) {
+        load();
+        return {};
+    }
+    const QVector<Document> &documents = data.documents;
+    QStringList queryTerms = tokenize(query);
+    if (queryTerms.isEmpty() || documents.isEmpty()) {
+        return {};
+    }
+    // The last word may still be being typed, so it matches as a prefix
+    bool lastIsPrefix = !query.isEmpty() && query.back().isLetterOrNumber();
+    double averageLength = qMax(1.0, static_cast<double>(data.totalLength) / documents.size());
+    QHash<int, double> scores;
+    QHash<int, int> matchedTerms;
+    QStringList highlighted;
+    for (int i = 0; i < queryTerms.size(); ++i) {
+        QStringList terms = (i == queryTerms.size() - 1 && lastIsPrefix) ? expand(queryTerms[i]) : QStringList{queryTerms[i]};
+        QSet<int> matchedHere;
+        for (const QString &term : terms) {
+            auto posting = data.postings.constFind(term);
+            if (posting == data.postings.constEnd()) {
+                continue;
+            }
+            highlighted.append(term);
+            double idf = std::log(1.0 + (documents.size() - posting->size() + 0.5) / (posting->size() + 0.5));
+            for (const Posting &entry : *posting) {
+                const Document &document = documents[entry.document];
+                if (document.removed) {
+                    continue;
+                }
+                double tf = entry.frequency;
+                scores[entry.document] += idf * tf * (K1 + 1) / (tf + K1 * (1 - B + B * document.length / averageLength));
+                matchedHere.insert(entry.document);
+            }
+        }
+        for (int document : matchedHere) {
+            matchedTerms[document]++;
+        }
+    }
+
+    // Every query word has to match
+    QVector<QPair<double, int>> ranked;
+    for (auto it = scores.constBegin(); it != scores.constEnd(); ++it) {
+        if (matchedTerms.value(it.key()) == queryTerms.size()) {
+            ranked.append({it.value(), it.key()});
+        }
+    }
+    int count = qMin(maxHits, static_cast<int>(ranked.size()));
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(), [&documents](const auto &a, const auto &b) {
+        if (a.first != b.first) {
+            return a.first > b.first;
+        }
+        return documents[a.second].day > documents[b.second].day;
+    });
+    QList<SearchHit> hits;
+    for (int i = 0; i < count; ++i) {
+        const Document &document = documents[ranked[i].second];
+        hits.append(SearchHit{QDate::fromJulianDay(document.day), document.time, document.isReport,
+                              document.text, snippet(document.text, highlighted), ranked[i].first});
+    }
+    return hits;
+}
+
+// Position of term as a whole word in text at or after from, or -1
+static int findWord(const QString &text, const QString &term, int from) {
+    for (int at = text.indexOf(term, from); at >= 0; at = text.indexOf(term, at + 1)) {
+        int end = at + term.size();
+        if ((at == 0 || !text.at(at - 1).isLetterOrNumber()) && (end == text.size() || !text.at(end).isLetterOrNumber())) {
+            return at;
+        }
+    }
+    return -1;
+}
+
+QString SearchIndex::snippet(const QString &text, const QStringList &terms) {
+    // Matches are found again on the folded text, which has the same length as the original for nearly all scripts
+    QString folded = text.toCaseFolded();
+    bool sameLength = folded.size() == text.size();
+    int first = -1;
+    for (const QString &term : terms) {
+        int position = sameLength ? findWord(folded, term, 0) : -1;
+        if (position >= 0 && (first < 0 || position < first)) {
+            first = position;
+        }
+    }
+    int start = qMax(0, first - SNIPPET_CONTEXT_CHARS);
+    int end = qMin(static_cast<int>(text.size()), qMax(first, 0) + 2 * SNIPPET_CONTEXT_CHARS);
+    QString html;
+    if (start > 0) {
+        html += "...";
+    }
+    int position = start;
+    while (position < end) {
+        int matchAt = -1;
+        int matchLength = 0;
+        for (const QString &term : terms) {
+            int at = sameLength ? findWord(folded, term, position) : -1;
+            if (at >= 0 && at < end && (matchAt < 0 || at < matchAt || (at == matchAt && term.size() > matchLength))) {
+                matchAt = at;
+                matchLength = term.size();
+            }
+        }
+        if (matchAt < 0) {
+            html += text.mid(position, end - position).toHtmlEscaped();
+            break;
+        }
+        html += text.mid(position, matchAt - position).toHtmlEscaped();
+        html += "<b>" + text.mid(matchAt, matchLength).toHtmlEscaped() + "</b>";
+        position = matchAt + matchLength;
+    }
+    if (end < text.size()) {
+        html += "...";
+    }
+    return html.replace("\n", " ");
+}
+
+int SearchIndex::documentCount() const {
+    return data.documents.size() - data.removedCount;
+}
+
+void SearchIndex::unload() {
+    // A build in progress finishes first; its result is small next to the work already done
+    if (state != Loaded) {
+        return;
+    }
+    state = Unloaded;
+    data = Index();
+}
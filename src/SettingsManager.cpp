@@ -1,4 +1,5 @@
 #include "SettingsManager.h"
+#include "StallWatchdog.h"
 
 const QString SETTINGS_TRANSLATION_MODEL_NAME_KEY = "translation_model_name";
 const QString SETTINGS_REPORT_MODEL_NAME_KEY = "report_model_name";
@@ -10,12 +11,34 @@ const QString SETTINGS_TRANSLATION_PROMPT_KEY = "translation_prompt";
 const QString SETTINGS_REPORT_PROMPT_KEY = "report_prompt";
 const QString SETTINGS_FEEDBACK_PROMPT_KEY = "feedback_prompt";
 const QString SETTINGS_MESSAGE_HISTORY_KEY = "message_history";
+const QString SETTINGS_HEDGE_TRANSLATIONS_KEY = "hedge_translations";
+const QString SETTINGS_TRANSLATION_PARALLELISM_KEY = "translation_parallelism";
+const QString SETTINGS_USE_TRANSLATION_MEMORY_KEY = "use_translation_memory";
+const QString SETTINGS_LOG_ARCHIVE_AFTER_DAYS_KEY = "log_archive_after_days";
+const QString SETTINGS_STALL_WATCHDOG_KEY = "stall_watchdog_enabled";
+const QString SETTINGS_STALL_THRESHOLD_KEY = "stall_threshold_ms";
+const QString SETTINGS_METRICS_EXPORT_KEY = "metrics_export_enabled";
+const QString SETTINGS_METRICS_PORT_KEY = "metrics_port";
+const QString SETTINGS_TRANSLATION_MODEL_TIERS_KEY = "translation_model_tiers";
+const QString SETTINGS_TRANSLATION_LATENCY_BUDGET_KEY = "translation_latency_budget_ms";
+const QString SETTINGS_PRECOMPUTE_REPORTS_KEY = "precompute_reports";
+const QString SETTINGS_PRECOMPUTE_REPORTS_TIME_KEY = "precompute_reports_time";
+const QString SETTINGS_PRECOMPUTE_REPORTS_BUDGET_KEY = "precompute_reports_token_budget";
+const QString SETTINGS_PRECOMPUTE_REPORTS_SPENT_DAY_KEY = "precompute_reports_spent_day";
+const QString SETTINGS_PRECOMPUTE_REPORTS_SPENT_KEY = "precompute_reports_spent_tokens";
+const QString SETTINGS_CHECK_SPELLING_KEY = "check_spelling";
+const QString SETTINGS_DETECT_DIRECTION_KEY = "detect_translation_direction";
+const QString SETTINGS_API_BASE_URL_KEY = "api_base_url";
+const QString SETTINGS_REPORT_BATCH_ID_KEY = "report_batch_id";
+const QString SETTINGS_REPORT_BATCH_DAYS_KEY = "report_batch_days";
+const QString SETTINGS_WATCH_CLIPBOARD_KEY = "watch_clipboard";
+const QString SETTINGS_CLIPBOARD_WATCH_MAX_CHARS_KEY = "clipboard_watch_max_chars";
 const int MAX_HISTORY_SIZE = 5;
 
 // Default prompts
 const QString DEFAULT_TRANSLATION_PROMPT = "You are an expert %sourceLang to %targetLang translator. Translate this text making sure to match the tone and style of the original.";
-const QString DEFAULT_REPORT_PROMPT = "You are an expert %sourceLang teacher. Find the top 5 grammatical mistakes in this %sourceLang text and correct them. Format each mistake as:\n\nORIGINAL: [mistake]\nCORRECTED: [correction]\nEXPLANATION: [brief English explanation]\n\nSeparate entries with two empty lines. If fewer than 5 grammatical errors exist, include important spelling mistakes.";
-const QString DEFAULT_FEEDBACK_PROMPT = "You are an expert %sourceLang teacher. Provide feedback on the syntax, grammar, and fluency of this %sourceLang text. Be constructive and specific. Format your response as:\n\nSYNTAX: [feedback on sentence structure]\nGRAMMAR: [feedback on grammatical correctness]\nFLUENCY: [feedback on naturalness and flow]\n\nKeep each section concise but helpful.";
+const QString DEFAULT_REPORT_PROMPT = "You are an expert %sourceLang teacher. Find the top 5 grammatical mistakes in this %sourceLang text and correct them. For each mistake give the original text, the corrected text, a brief English explanation and the category that fits it best. If fewer than 5 grammatical errors exist, include important spelling mistakes.";
+const QString DEFAULT_FEEDBACK_PROMPT = "You are an expert %sourceLang teacher. Provide feedback on the syntax, grammar, and fluency of each sentence of this %sourceLang text. Be constructive and specific, and keep the feedback for each sentence concise but helpful.";
 
 SettingsManager::SettingsManager(QObject *parent)
     : QObject(parent), settings(parent)
@@ -28,6 +51,15 @@ QString SettingsManager::translationModelName() const {
 void SettingsManager::setTranslationModelName(const QString &name) {
     settings.setValue(SETTINGS_TRANSLATION_MODEL_NAME_KEY, name);
 }
+QString SettingsManager::translationModelTiers() const {
+    return settings.value(SETTINGS_TRANSLATION_MODEL_TIERS_KEY, "").toString();
+}
+void SettingsManager::setTranslationModelTiers(const QString &tiers) {
+    settings.setValue(SETTINGS_TRANSLATION_MODEL_TIERS_KEY, tiers);
+}
+int SettingsManager::translationLatencyBudgetMs() const {
+    return settings.value(SETTINGS_TRANSLATION_LATENCY_BUDGET_KEY, 8000).toInt();
+}
 QString SettingsManager::reportModelName() const {
     return settings.value(SETTINGS_REPORT_MODEL_NAME_KEY, "gpt-4.1").toString();
 }
@@ -59,6 +91,27 @@ void SettingsManager::setLastInputText(const QString &text) {
     settings.setValue(SETTINGS_LAST_INPUT_KEY, text);
 }
 
+bool SettingsManager::hedgeTranslations() const {
+    return settings.value(SETTINGS_HEDGE_TRANSLATIONS_KEY, false).toBool();
+}
+void SettingsManager::setHedgeTranslations(bool enabled) {
+    settings.setValue(SETTINGS_HEDGE_TRANSLATIONS_KEY, enabled);
+}
+
+int SettingsManager::translationParallelism() const {
+    return settings.value(SETTINGS_TRANSLATION_PARALLELISM_KEY, 3).toInt();
+}
+void SettingsManager::setTranslationParallelism(int parallelism) {
+    settings.setValue(SETTINGS_TRANSLATION_PARALLELISM_KEY, parallelism);
+}
+
+bool SettingsManager::useTranslationMemory() const {
+    return settings.value(SETTINGS_USE_TRANSLATION_MEMORY_KEY, false).toBool();
+}
+void SettingsManager::setUseTranslationMemory(bool enabled) {
+    settings.setValue(SETTINGS_USE_TRANSLATION_MEMORY_KEY, enabled);
+}
+
 QString SettingsManager::translationPrompt() const {
     return settings.value(SETTINGS_TRANSLATION_PROMPT_KEY, getDefaultTranslationPrompt()).toString();
 }
@@ -92,6 +145,102 @@ QString SettingsManager::getDefaultFeedbackPrompt() const {
     return DEFAULT_FEEDBACK_PROMPT;
 }
 
+int SettingsManager::logArchiveAfterDays() const {
+    return settings.value(SETTINGS_LOG_ARCHIVE_AFTER_DAYS_KEY, 60).toInt();
+}
+void SettingsManager::setLogArchiveAfterDays(int days) {
+    settings.setValue(SETTINGS_LOG_ARCHIVE_AFTER_DAYS_KEY, days);
+}
+
+bool SettingsManager::stallWatchdogEnabled() const {
+    return settings.value(SETTINGS_STALL_WATCHDOG_KEY, false).toBool();
+}
+void SettingsManager::setStallWatchdogEnabled(bool enabled) {
+    settings.setValue(SETTINGS_STALL_WATCHDOG_KEY, enabled);
+}
+int SettingsManager::stallThresholdMs() const {
+    return settings.value(SETTINGS_STALL_THRESHOLD_KEY, 100).toInt();
+}
+
+bool SettingsManager::metricsExportEnabled() const {
+    return settings.value(SETTINGS_METRICS_EXPORT_KEY, false).toBool();
+}
+void SettingsManager::setMetricsExportEnabled(bool enabled) {
+    settings.setValue(SETTINGS_METRICS_EXPORT_KEY, enabled);
+}
+int SettingsManager::metricsPort() const {
+    return settings.value(SETTINGS_METRICS_PORT_KEY, 9477).toInt();
+}
+
+QString SettingsManager::apiBaseUrl() const {
+    return settings.value(SETTINGS_API_BASE_URL_KEY, "https://api.openai.com/v1").toString();
+}
+void SettingsManager::setApiBaseUrl(const QString &url) {
+    settings.setValue(SETTINGS_API_BASE_URL_KEY, url);
+}
+
+bool SettingsManager::detectTranslationDirection() const {
+    return settings.value(SETTINGS_DETECT_DIRECTION_KEY, false).toBool();
+}
+void SettingsManager::setDetectTranslationDirection(bool enabled) {
+    settings.setValue(SETTINGS_DETECT_DIRECTION_KEY, enabled);
+}
+bool SettingsManager::watchClipboard() const {
+    return settings.value(SETTINGS_WATCH_CLIPBOARD_KEY, false).toBool();
+}
+void SettingsManager::setWatchClipboard(bool enabled) {
+    settings.setValue(SETTINGS_WATCH_CLIPBOARD_KEY, enabled);
+}
+int SettingsManager::clipboardWatchMaxChars() const {
+    return settings.value(SETTINGS_CLIPBOARD_WATCH_MAX_CHARS_KEY, 1000).toInt();
+}
+
+bool SettingsManager::checkSpelling() const {
+    return settings.value(SETTINGS_CHECK_SPELLING_KEY, true).toBool();
+}
+void SettingsManager::setCheckSpelling(bool enabled) {
+    settings.setValue(SETTINGS_CHECK_SPELLING_KEY, enabled);
+}
+
+bool SettingsManager::precomputeReports() const {
+    return settings.value(SETTINGS_PRECOMPUTE_REPORTS_KEY, false).toBool();
+}
+void SettingsManager::setPrecomputeReports(bool enabled) {
+    settings.setValue(SETTINGS_PRECOMPUTE_REPORTS_KEY, enabled);
+}
+QString SettingsManager::precomputeReportsTime() const {
+    return settings.value(SETTINGS_PRECOMPUTE_REPORTS_TIME_KEY, "").toString();
+}
+void SettingsManager::setPrecomputeReportsTime(const QString &time) {
+    settings.setValue(SETTINGS_PRECOMPUTE_REPORTS_TIME_KEY, time);
+}
+int SettingsManager::precomputeReportsTokenBudget() const {
+    return settings.value(SETTINGS_PRECOMPUTE_REPORTS_BUDGET_KEY, 100000).toInt();
+}
+int SettingsManager::precomputeReportsTokensSpent(const QDate &day) const {
+    // The budget is per day, so anything spent on an earlier day no longer counts
+    if (settings.value(SETTINGS_PRECOMPUTE_REPORTS_SPENT_DAY_KEY).toDate() != day) {
+        return 0;
+    }
+    return settings.value(SETTINGS_PRECOMPUTE_REPORTS_SPENT_KEY, 0).toInt();
+}
+void SettingsManager::setPrecomputeReportsTokensSpent(const QDate &day, int tokens) {
+    settings.setValue(SETTINGS_PRECOMPUTE_REPORTS_SPENT_DAY_KEY, day);
+    settings.setValue(SETTINGS_PRECOMPUTE_REPORTS_SPENT_KEY, tokens);
+}
+QString SettingsManager::reportBatchId() const {
+    return settings.value(SETTINGS_REPORT_BATCH_ID_KEY, "").toString();
+}
+void SettingsManager::setReportBatchId(const QString &batchId) {
+    settings.setValue(SETTINGS_REPORT_BATCH_ID_KEY, batchId);
+}
+QStringList SettingsManager::reportBatchDays() const {
+    return settings.value(SETTINGS_REPORT_BATCH_DAYS_KEY).toStringList();
+}
+void SettingsManager::setReportBatchDays(const QStringList &dateStrings) {
+    settings.setValue(SETTINGS_REPORT_BATCH_DAYS_KEY, dateStrings);
+}
+
 QStringList SettingsManager::getMessageHistory() const {
     QVariant historyVariant = settings.value(SETTINGS_MESSAGE_HISTORY_KEY);
     if (historyVariant.canConvert<QStringList>()) {
@@ -122,5 +271,6 @@ void SettingsManager::addMessageToHistory(const QString &message) {
 }
 
 void SettingsManager::sync() {
+    StallWatchdog::Operation operation("SettingsManager::sync");
     settings.sync();
 } 
\ No newline at end of file
@@ -8,6 +8,9 @@
 #include <QMainWindow>
 
 const QString SingleInstance::SHARED_MEMORY_KEY = "immersion_single_instance";
+const int MESSAGE_CHECK_INTERVAL_MS = 100;
+// Coming back from idle may take this long, in exchange for far fewer wakeups
+const int IDLE_MESSAGE_CHECK_INTERVAL_MS = 500;
 
 SingleInstance::SingleInstance(QObject *parent)
     : QObject(parent)
@@ -76,7 +79,14 @@ void SingleInstance::startListening()
     // Create a timer to periodically check for messages
     m_messageCheckTimer = new QTimer(this);
     connect(m_messageCheckTimer, &QTimer::timeout, this, &SingleInstance::checkForMessages);
-    m_messageCheckTimer->start(100); // Check every 100ms
+    m_messageCheckTimer->start(MESSAGE_CHECK_INTERVAL_MS);
+}
+
+void SingleInstance::setIdle(bool idle)
+{
+    if (m_messageCheckTimer) {
+        m_messageCheckTimer->setInterval(idle ? IDLE_MESSAGE_CHECK_INTERVAL_MS : MESSAGE_CHECK_INTERVAL_MS);
+    }
 }
 
 void SingleInstance::checkForMessages()
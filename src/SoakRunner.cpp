@@ -0,0 +1,162 @@
+#include "SoakRunner.h"
+#include "FeedbackDialog.h"
+#include <QMainWindow>
+#include <QApplication>
+#include <QPlainTextEdit>
+#include <QCheckBox>
+#include <QMenu>
+#include <QAction>
+#include <QDesktopServices>
+#include <QFile>
+#include <QTextStream>
+#include <QDebug>
+
+// Cycles before the baseline is taken, so caches and lazily created objects are warm
+const int WARMUP_CYCLES = 50;
+const int REPORT_EVERY = 10;
+const int SAMPLE_EVERY = 100;
+const int MAX_OBJECT_GROWTH = 20;
+const qint64 MAX_RSS_GROWTH_KB = 16 * 1024;
+const int POLL_INTERVAL_MS = 5;
+
+SoakRunner::SoakRunner(QMainWindow *window_, int cycles_, QObject *parent)
+    : QObject(parent)
+    , window(window_)
+    , cycles(cycles_)
+    , cycle(0)
+    , step(StepTranslate)
+    , stepTimer(new QTimer(this))
+    , baselineRssKb(-1)
+    , baselineObjects(-1)
+    , peakRssKb(0)
+    , peakObjects(0)
+{
+    stepTimer->setInterval(POLL_INTERVAL_MS);
+    connect(stepTimer, &QTimer::timeout, this, &SoakRunner::nextStep);
+}
+
+void SoakRunner::start() {
+    // Reports open their folder when written; a soak run must not open thousands of windows
+    QDesktopServices::setUrlHandler("file", this, "ignoreUrl");
+    qDebug() << "Soak test:" << cycles << "cycles";
+    stepTimer->start();
+}
+
+void SoakRunner::ignoreUrl(const QUrl &) {
+}
+
+qint64 SoakRunner::residentMemoryKb() {
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return -1;
+    }
+    while (!status.atEnd()) {
+        QByteArray line = status.readLine();
+        if (line.startsWith("VmRSS:")) {
+            return line.mid(6).trimmed().split(' ').value(0).toLongLong();
+        }
+    }
+    return -1;
+}
+
+int SoakRunner::objectCount() const {
+    int count = 0;
+    for (QWidget *widget : QApplication::topLevelWidgets()) {
+        count += 1 + widget->findChildren<QObject*>().size();
+    }
+    return count;
+}
+
+bool SoakRunner::busy() const {
+    return !window->isEnabled() || window->property("busy").toBool();
+}
+
+void SoakRunner::nextStep() {
+    // Feedback dialogs are the only thing that waits for the user
+    for (FeedbackDialog *dialog : window->findChildren<FeedbackDialog*>()) {
+        if (dialog->isVisible()) {
+            dialog->close();
+        }
+    }
+    switch (step) {
+        case StepTranslate: {
+            auto input = window->findChild<QPlainTextEdit*>("inputText");
+            auto feedback = window->findChild<QCheckBox*>("quickFeedbackCheckBox");
+            QString text = QString("Dette er soak cyklus %1. Vi skriver nogle sætninger. ").arg(cycle);
+            // Every fifth input is long enough to be split into parallel chunks
+            if (cycle % 5 == 0) {
+                text = text.repeated(40);
+            }
+            input->setPlainText(text);
+            feedback->setChecked(cycle % 2 == 0);
+            window->show();
+            QMetaObject::invokeMethod(window, "on_goButton_clicked");
+            step = StepWaitTranslate;
+            break;
+        }
+        case StepWaitTranslate:
+            if (!busy()) {
+                step = cycle % REPORT_EVERY == 0 ? StepReport : StepHistory;
+            }
+            break;
+        case StepReport:
+            QMetaObject::invokeMethod(window, "actionGenerateMistakesReport");
+            step = StepWaitReport;
+            break;
+        case StepWaitReport:
+            if (!busy()) {
+                step = StepHistory;
+            }
+            break;
+        case StepHistory: {
+            auto history = window->findChild<QMenu*>("menuHistory");
+            if (history && !history->actions().isEmpty()) {
+                history->actions().constFirst()->trigger();
+            }
+            sample();
+            if (++cycle >= cycles) {
+                finish();
+                return;
+            }
+            step = StepTranslate;
+            break;
+        }
+    }
+}
+
+void SoakRunner::sample() {
+    // Let deleteLater() and queued worker results settle before measuring
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    qint64 rss = residentMemoryKb();
+    int objects = objectCount();
+    if (cycle == WARMUP_CYCLES) {
+        baselineRssKb = rss;
+        baselineObjects = objects;
+    }
+    if (cycle >= WARMUP_CYCLES) {
+        peakRssKb = qMax(peakRssKb, rss);
+        peakObjects = qMax(peakObjects, objects);
+    }
+    if (cycle % SAMPLE_EVERY == 0) {
+        qDebug() << "Soak cycle" << cycle << "RSS" << rss << "kB, objects" << objects;
+    }
+}
+
+void SoakRunner::finish() {
+    stepTimer->stop();
+    QTextStream out(stdout);
+    if (baselineObjects < 0) {
+        out << "Soak test needs more than " << WARMUP_CYCLES << " cycles to take a baseline\n";
+        emit finished(false);
+        return;
+    }
+    bool objectsOk = peakObjects - baselineObjects <= MAX_OBJECT_GROWTH;
+    // RSS is not available everywhere; object counts are still checked
+    bool rssOk = baselineRssKb < 0 || peakRssKb - baselineRssKb <= MAX_RSS_GROWTH_KB;
+    out << "Soak test: " << cycles << " cycles\n"
+        << "  objects: baseline " << baselineObjects << ", peak " << peakObjects
+        << (objectsOk ? " (ok)" : " (LEAK)") << "\n"
+        << "  RSS: baseline " << baselineRssKb << " kB, peak " << peakRssKb << " kB"
+        << (rssOk ? " (ok)" : " (GROWING)") << "\n";
+    emit finished(objectsOk && rssOk);
+}
@@ -0,0 +1,123 @@
+#include "SpellChecker.h"
+#include "AppDataManager.h"
+#include <QtConcurrent>
+#include <QRegularExpression>
+#include <QLocale>
+#include <QFileInfo>
+#include <QDebug>
+
+const int MAX_CACHED_VERDICTS = 20000;
+// Very short words and acronyms produce more false alarms than useful hints
+const int MIN_CHECKED_WORD_LENGTH = 2;
+
+SpellChecker::SpellChecker(QTextDocument *document)
+    : QSyntaxHighlighter(document)
+    , loader(new QFutureWatcher<QSharedPointer<const WordTrie>>(this))
+    , enabled(true)
+{
+    misspelledFormat.setUnderlineStyle(QTextCharFormat::SpellCheckUnderline);
+    misspelledFormat.setUnderlineColor(Qt::red);
+    connect(loader, &QFutureWatcher<QSharedPointer<const WordTrie>>::finished, this, &SpellChecker::dictionaryLoaded);
+}
+
+QStringList SpellChecker::dictionaryCandidates(const QString &languageName) {
+    QStringList names{languageName.toLower()};
+    // "Danish" -> "da_DK" and "da", the names Hunspell dictionaries use
+    for (int value = QLocale::AnyLanguage + 1; value <= QLocale::LastLanguage; ++value) {
+        auto language = static_cast<QLocale::Language>(value);
+        if (QLocale::languageToString(language).compare(languageName, Qt::CaseInsensitive) == 0) {
+            QLocale locale(language);
+            names.append(locale.name());
+            names.append(locale.name().section('_', 0, 0));
+            break;
+        }
+    }
+    QStringList directories{AppDataManager::getAppDataPath() + "/dictionaries",
+                            "/usr/share/hunspell", "/usr/share/myspell", "/usr/share/myspell/dicts"};
+    QStringList candidates;
+    for (const QString &directory : directories) {
+        for (const QString &name : names) {
+            candidates.append(directory + "/" + name + ".txt");
+            candidates.append(directory + "/" + name + ".dic");
+        }
+    }
+    return candidates;
+}
+
+void SpellChecker::setLanguage(const QString &languageName) {
+    if (languageName == language) {
+        return;
+    }
+    language = languageName;
+    dictionary.reset();
+    verdicts.clear();
+    rehighlight();
+    QStringList candidates = dictionaryCandidates(languageName);
+    loader->setFuture(QtConcurrent::run([candidates]() {
+        for (const QString &path : candidates) {
+            if (QFileInfo::exists(path)) {
+                return QSharedPointer<const WordTrie>::create(WordTrie::build(WordTrie::loadWordList(path)));
+            }
+        }
+        return QSharedPointer<const WordTrie>();
+    }));
+}
+
+void SpellChecker::dictionaryLoaded() {
+    dictionary = loader->result();
+    verdicts.clear();
+    if (dictionary) {
+        qDebug() << "Loaded" << dictionary->wordCount() << "dictionary words for" << language;
+    } else {
+        qDebug() << "No dictionary found for" << language;
+    }
+    rehighlight();
+}
+
+void SpellChecker::setEnabled(bool enabled_) {
+    if (enabled_ != enabled) {
+        enabled = enabled_;
+        rehighlight();
+    }
+}
+
+void SpellChecker::releaseDictionary() {
+    language.clear();
+    dictionary.reset();
+    verdicts = QHash<QString, bool>();
+}
+
+bool SpellChecker::isMisspelled(const QString &word) {
+    if (!enabled || !dictionary || dictionary->isEmpty() || word.size() < MIN_CHECKED_WORD_LENGTH
+        || word == word.toUpper()) {
+        return false;
+    }
+    auto it = verdicts.constFind(word);
+    if (it != verdicts.constEnd()) {
+        return it.value();
+    }
+    bool misspelled = !dictionary->contains(word);
+    if (verdicts.size() >= MAX_CACHED_VERDICTS) {
+        verdicts.clear();
+    }
+    verdicts.insert(word, misspelled);
+    return misspelled;
+}
+
+QStringList SpellChecker::suggestions(const QString &word) const {
+    return dictionary ? dictionary->suggestions(word) : QStringList();
+}
+
+void SpellChecker::highlightBlock(const QString &text) {
+    if (!enabled || !dictionary) {
+        return;
+    }
+    static const QRegularExpression wordPattern("[\\p{L}\\p{M}]+(?:['’][\\p{L}\\p{M}]+)*");
+    auto matches = wordPattern.globalMatch(text);
+    while (matches.hasNext()) {
+        auto match = matches.next();
+        if (isMisspelled(match.captured())) {
+            setFormat(static_cast<int>(match.capturedStart()), static_cast<int>(match.capturedLength()), misspelledFormat);
+        }
+    }
+}
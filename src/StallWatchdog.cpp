@@ -0,0 +1,97 @@
+#include "StallWatchdog.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QDebug>
+
+std::atomic<const char*> StallWatchdog::currentOperation{nullptr};
+
+const int PING_INTERVAL_MS = 250;
+
+StallWatchdog::StallWatchdog(const QString &reportPath_, QObject *parent)
+    : QThread(parent)
+    , reportPath(reportPath_)
+    , thresholdMs(100)
+    , lastAnsweredPing(-1)
+    , stalls(0)
+{
+    clock.start();
+}
+
+StallWatchdog::~StallWatchdog()
+{
+    stop();
+}
+
+void StallWatchdog::setThresholdMs(int threshold) {
+    thresholdMs = qMax(10, threshold);
+}
+
+void StallWatchdog::stop() {
+    requestInterruption();
+    wait();
+}
+
+int StallWatchdog::stallCount() const {
+    return stalls;
+}
+
+StallWatchdog::Operation::Operation(const char *name)
+    : active(QThread::currentThread() == QCoreApplication::instance()->thread())
+    , previous(active ? currentOperation.exchange(name) : nullptr)
+{
+}
+
+StallWatchdog::Operation::~Operation()
+{
+    // Only the GUI thread is watched, so tags from worker threads are ignored
+    if (active) {
+        currentOperation = previous;
+    }
+}
+
+void StallWatchdog::run() {
+    while (!isInterruptionRequested()) {
+        qint64 sentAt = clock.elapsed();
+        // The thread object lives on the GUI thread, so a ping still queued when it is deleted is dropped with it
+        QMetaObject::invokeMethod(this, [this, sentAt]() {
+            lastAnsweredPing = sentAt;
+        }, Qt::QueuedConnection);
+
+        // Poll a few times per threshold until the GUI thread answers
+        int pollInterval = qMax(5, thresholdMs / 4);
+        const char *operation = nullptr;
+        bool stalled = false;
+        while (!isInterruptionRequested() && lastAnsweredPing != sentAt) {
+            msleep(pollInterval);
+            if (clock.elapsed() - sentAt > thresholdMs) {
+                stalled = true;
+                if (!operation) {
+                    operation = currentOperation.load();
+                }
+            }
+        }
+        if (stalled && lastAnsweredPing == sentAt) {
+            recordStall(sentAt, clock.elapsed() - sentAt, operation);
+        }
+        msleep(PING_INTERVAL_MS);
+    }
+}
+
+void StallWatchdog::recordStall(qint64 startedAtMs, qint64 durationMs, const char *operation) {
+    stalls++;
+    QDateTime startedAt = QDateTime::currentDateTime().addMSecs(startedAtMs - clock.elapsed());
+    QString line = QString("%1  %2 ms  %3\n")
+                       .arg(startedAt.toString("yyyy-MM-dd HH:mm:ss.zzz"))
+                       .arg(durationMs, 6)
+                       .arg(operation ? QString::fromLatin1(operation) : QString("(untagged)"));
+    qWarning().noquote() << "GUI thread stalled:" << line.trimmed();
+
+    QDir().mkpath(QFileInfo(reportPath).absolutePath());
+    QFile file(reportPath);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        file.write(line.toUtf8());
+    }
+}
@@ -0,0 +1,66 @@
+#include "TextSegmenter.h"
+#include <QRegularExpression>
+
+QList<TextSegment> TextSegmenter::splitSentences(const QString &text) {
+    // Either sentence-final punctuation (plus closing quotes/brackets) followed by whitespace, or a line break
+    static const QRegularExpression boundary(QStringLiteral("([.!?…]+[\"'»”)\\]]*)(\\s+)|(\\s*\\n\\s*)"));
+
+    QList<TextSegment> segments;
+    int position = 0;
+    auto appendSegment = [&segments](const QString &segmentText, const QString &separator) {
+        if (segmentText.trimmed().isEmpty() && !segments.isEmpty()) {
+            segments.last().separator += segmentText + separator;
+            return;
+        }
+        segments.append(TextSegment{segmentText, separator});
+    };
+
+    auto it = boundary.globalMatch(text);
+    while (it.hasNext()) {
+        auto match = it.next();
+        if (match.hasCaptured(1)) {
+            appendSegment(text.mid(position, match.capturedEnd(1) - position), match.captured(2));
+        } else {
+            appendSegment(text.mid(position, match.capturedStart(3) - position), match.captured(3));
+        }
+        position = match.capturedEnd(0);
+    }
+    if (position < text.length()) {
+        appendSegment(text.mid(position), QString());
+    }
+    return segments;
+}
+
+bool TextSegmenter::isParagraphBreak(const QString &separator) {
+    return separator.count('\n') >= 2;
+}
+
+QList<TextSegment> TextSegmenter::splitChunks(const QString &text, int maxChunkChars) {
+    QList<TextSegment> chunks;
+    TextSegment current;
+    for (const TextSegment &sentence : splitSentences(text)) {
+        if (!current.text.isEmpty() && current.text.length() + current.separator.length() + sentence.text.length() > maxChunkChars) {
+            chunks.append(current);
+            current = TextSegment();
+        }
+        current.text += current.separator + sentence.text;
+        current.separator = sentence.separator;
+        // Paragraph ends are the preferred place to cut once a chunk has some substance
+        if (isParagraphBreak(sentence.separator) && current.text.length() >= maxChunkChars / 2) {
+            chunks.append(current);
+            current = TextSegment();
+        }
+    }
+    if (!current.text.isEmpty() || !current.separator.isEmpty()) {
+        chunks.append(current);
+    }
+    return chunks;
+}
+
+QString TextSegmenter::join(const QList<TextSegment> &segments) {
+    QString result;
+    for (const TextSegment &segment : segments) {
+        result += segment.text + segment.separator;
+    }
+    return result;
+}
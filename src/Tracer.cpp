@@ -0,0 +1,135 @@
+#include "Tracer.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+#include <QHash>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QCoreApplication>
+
+std::atomic<bool> Tracer::enabled{false};
+
+namespace {
+struct TraceEvent {
+    const char *name;
+    char phase;
+    qint64 timestampUs;
+    qint64 durationUs;
+    quint64 id;
+    int threadId;
+    QString detail;
+};
+
+QMutex traceMutex;
+QVector<TraceEvent> traceEvents;
+QHash<Qt::HANDLE, int> threadIds;
+QHash<int, QString> threadNames;
+
+QElapsedTimer &traceClock() {
+    static QElapsedTimer clock;
+    if (!clock.isValid()) {
+        clock.start();
+    }
+    return clock;
+}
+
+// Must be called with traceMutex held
+int currentThreadId() {
+    Qt::HANDLE handle = QThread::currentThreadId();
+    auto it = threadIds.constFind(handle);
+    if (it != threadIds.constEnd()) {
+        return it.value();
+    }
+    int id = threadIds.size() + 1;
+    threadIds.insert(handle, id);
+    QString name = QThread::currentThread()->objectName();
+    if (QThread::currentThread() == QCoreApplication::instance()->thread()) {
+        name = "GUI";
+    }
+    threadNames.insert(id, name.isEmpty() ? QString("Thread %1").arg(id) : name);
+    return id;
+}
+}
+
+qint64 Tracer::nowUs() {
+    return traceClock().nsecsElapsed() / 1000;
+}
+
+void Tracer::start() {
+    QMutexLocker locker(&traceMutex);
+    traceEvents.clear();
+    traceClock();
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::addComplete(const char *name, qint64 startUs, qint64 durationUs) {
+    QMutexLocker locker(&traceMutex);
+    if (!isEnabled()) {
+        return;
+    }
+    traceEvents.append(TraceEvent{name, 'X', startUs, durationUs, 0, currentThreadId(), QString()});
+}
+
+void Tracer::asyncBegin(const char *name, quint64 id, const QString &detail) {
+    if (!isEnabled()) {
+        return;
+    }
+    QMutexLocker locker(&traceMutex);
+    traceEvents.append(TraceEvent{name, 'b', nowUs(), 0, id, currentThreadId(), detail});
+}
+
+void Tracer::asyncEnd(const char *name, quint64 id) {
+    if (!isEnabled()) {
+        return;
+    }
+    QMutexLocker locker(&traceMutex);
+    traceEvents.append(TraceEvent{name, 'e', nowUs(), 0, id, currentThreadId(), QString()});
+}
+
+bool Tracer::stop(const QString &filePath) {
+    enabled.store(false, std::memory_order_relaxed);
+    QMutexLocker locker(&traceMutex);
+
+    QJsonArray events;
+    qint64 pid = QCoreApplication::applicationPid();
+    for (auto it = threadNames.constBegin(); it != threadNames.constEnd(); ++it) {
+        events.append(QJsonObject{
+            {"name", "thread_name"}, {"ph", "M"}, {"pid", pid}, {"tid", it.key()},
+            {"args", QJsonObject{{"name", it.value()}}}
+        });
+    }
+    for (const TraceEvent &event : traceEvents) {
+        QJsonObject object{
+            {"name", event.name},
+            {"cat", "immersion"},
+            {"ph", QString(QChar(event.phase))},
+            {"ts", event.timestampUs},
+            {"pid", pid},
+            {"tid", event.threadId},
+        };
+        if (event.phase == 'X') {
+            object["dur"] = event.durationUs;
+        } else {
+            object["id"] = QString::number(event.id, 16);
+        }
+        if (!event.detail.isEmpty()) {
+            object["args"] = QJsonObject{{"detail", event.detail}};
+        }
+        events.append(object);
+    }
+    traceEvents.clear();
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(QJsonObject{{"traceEvents", events}, {"displayTimeUnit", "ms"}}).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
@@ -0,0 +1,273 @@
+#include "TranslationJob.h"
+#include "OpenAICommunicator.h"
+#include "TranslationMemory.h"
+#include "ModelRouter.h"
+#include "Metrics.h"
+#include <QDebug>
+
+// Inputs up to this size keep the single request path
+const int CHUNKING_THRESHOLD_CHARS = 1500;
+const int MAX_CHUNK_CHARS = 1000;
+const int MAX_PARALLEL_CHUNKS = 4;
+// How much of the neighbouring chunks is shown to the model to keep the tone consistent
+const int CHUNK_CONTEXT_CHARS = 200;
+const int MAX_MEMORY_EXAMPLES = 6;
+
+TranslationJob::TranslationJob(const QString &apiKey_, QObject *parent)
+    : QObject(parent)
+    , apiKey(apiKey_)
+    , modelStats(nullptr)
+    , hedgingEnabled(false)
+    , translationMemory(nullptr)
+    , priority(RequestScheduler::PriorityInteractive)
+    , segmentMode(false)
+    , nextGroup(0)
+    , remainingGroups(0)
+    , memoryMatches(0)
+    , savedTokens(0)
+    , done(false)
+    , launching(false)
+{
+}
+
+void TranslationJob::setModelName(const QString &name) {
+    modelName = name;
+}
+
+void TranslationJob::setModelStats(ModelStats *stats) {
+    modelStats = stats;
+}
+
+void TranslationJob::setHedgingEnabled(bool enabled) {
+    hedgingEnabled = enabled;
+}
+
+void TranslationJob::setTranslationMemory(TranslationMemory *memory) {
+    translationMemory = memory;
+}
+
+void TranslationJob::setPriority(RequestScheduler::Priority priority_) {
+    priority = priority_;
+}
+
+void TranslationJob::setPromptTemplate(const QString &promptTemplate_, const QString &sourceLang_, const QString &targetLang_) {
+    promptTemplate = promptTemplate_;
+    sourceLang = sourceLang_;
+    targetLang = targetLang_;
+}
+
+int TranslationJob::chunkCount() const {
+    return groups.size();
+}
+
+int TranslationJob::segmentCount() const {
+    return segments.size();
+}
+
+int TranslationJob::memoryMatchCount() const {
+    return memoryMatches;
+}
+
+int TranslationJob::tokensSaved() const {
+    return savedTokens;
+}
+
+OpenAICommunicator *TranslationJob::createCommunicator() {
+    auto communicator = new OpenAICommunicator(apiKey, this);
+    communicator->setModelName(modelName);
+    communicator->setModelStats(modelStats);
+    communicator->setHedgingEnabled(hedgingEnabled);
+    communicator->setPriority(priority);
+    runningCommunicators.append(communicator);
+    return communicator;
+}
+
+void TranslationJob::planChunks(const QString &inputText) {
+    if (inputText.length() <= CHUNKING_THRESHOLD_CHARS) {
+        segments = {TextSegment{inputText, QString()}};
+    } else {
+        segments = TextSegmenter::splitChunks(inputText, MAX_CHUNK_CHARS);
+        qDebug() << "Translating" << inputText.length() << "characters in" << segments.size() << "chunks";
+    }
+    translatedSegments = QVector<QString>(segments.size());
+    for (int i = 0; i < segments.size(); ++i) {
+        if (segments[i].text.trimmed().isEmpty()) {
+            // Nothing to translate, keep the whitespace as it is
+            translatedSegments[i] = segments[i].text;
+            continue;
+        }
+        groups.append(Group{{i}, contextPrompt(i)});
+    }
+}
+
+void TranslationJob::planWithMemory(const QString &inputText) {
+    segments = TextSegmenter::splitSentences(inputText);
+    translatedSegments = QVector<QString>(segments.size());
+
+    QStringList examples;
+    Group current;
+    int currentChars = 0;
+    int translatableSegments = 0;
+    auto closeGroup = [&]() {
+        if (current.segmentIndexes.isEmpty()) {
+            return;
+        }
+        if (!examples.isEmpty()) {
+            current.extraPrompt = "\n\nPreviously approved translations of similar sentences, to reuse where they fit:\n" + examples.join("\n");
+        }
+        groups.append(current);
+        current = Group();
+        currentChars = 0;
+        examples.clear();
+    };
+
+    for (int i = 0; i < segments.size(); ++i) {
+        const QString &text = segments[i].text;
+        if (text.trimmed().isEmpty()) {
+            translatedSegments[i] = text;
+            continue;
+        }
+        translatableSegments++;
+        QString cached;
+        if (translationMemory->lookupExact(text, sourceLang, targetLang, &cached)) {
+            translatedSegments[i] = cached;
+            memoryMatches++;
+            savedTokens += ModelRouter::estimateTokens(text);
+            continue;
+        }
+        if (currentChars + text.length() > MAX_CHUNK_CHARS) {
+            closeGroup();
+        }
+        current.segmentIndexes.append(i);
+        currentChars += text.length();
+        const auto nearMatches = translationMemory->lookupFuzzy(text, sourceLang, targetLang);
+        for (const auto &match : nearMatches) {
+            if (examples.size() < MAX_MEMORY_EXAMPLES) {
+                examples.append("\"" + match.source + "\" => \"" + match.target + "\"");
+            }
+        }
+    }
+    closeGroup();
+
+    translationMemory->recordUsage(translatableSegments, memoryMatches, savedTokens);
+    Metrics::instance().recordMemoryLookups(translatableSegments, memoryMatches);
+    qDebug() << "Translation memory matched" << memoryMatches << "of" << translatableSegments
+             << "segments, saving about" << savedTokens << "tokens ("
+             << translationMemory->totalExactMatches() << "of" << translationMemory->totalSegments()
+             << "segments and" << translationMemory->totalTokensSaved() << "tokens overall)";
+}
+
+void TranslationJob::start(const QString &inputText) {
+    segmentMode = translationMemory != nullptr;
+    if (segmentMode) {
+        planWithMemory(inputText);
+    } else {
+        planChunks(inputText);
+    }
+    remainingGroups = groups.size();
+    nextGroup = 0;
+    if (remainingGroups == 0) {
+        // Everything was filled without a request
+        groupFinished(Group(), QStringList());
+        return;
+    }
+    launchGroups();
+}
+
+void TranslationJob::launchGroups() {
+    // A chunk that finishes inside sendRequest would otherwise start the next one from
+    // within this loop, past the parallel limit
+    if (launching) {
+        return;
+    }
+    launching = true;
+    while (!done && nextGroup < groups.size() && runningCommunicators.size() < MAX_PARALLEL_CHUNKS) {
+        startNextGroup();
+    }
+    launching = false;
+}
+
+QString TranslationJob::contextPrompt(int chunkIndex) const {
+    if (segments.size() == 1) {
+        return QString();
+    }
+    QString context = "\n\nThe text is one part of a longer document; translate only this part.";
+    if (chunkIndex > 0) {
+        context += "\nFor context only, the previous part ends with: \"" + segments[chunkIndex - 1].text.right(CHUNK_CONTEXT_CHARS) + "\"";
+    }
+    if (chunkIndex + 1 < segments.size()) {
+        context += "\nFor context only, the next part starts with: \"" + segments[chunkIndex + 1].text.left(CHUNK_CONTEXT_CHARS) + "\"";
+    }
+    return context;
+}
+
+void TranslationJob::startNextGroup() {
+    const Group group = groups[nextGroup++];
+    auto communicator = createCommunicator();
+    if (segmentMode) {
+        QStringList sources;
+        for (int index : group.segmentIndexes) {
+            sources.append(segments[index].text);
+        }
+        communicator->setPromptWithTemplate(promptTemplate, sourceLang, targetLang, QString());
+        communicator->setContext(group.extraPrompt.trimmed());
+        communicator->setSegments(sources);
+        connect(communicator, &OpenAICommunicator::segmentsReceived, this, [=](const QStringList &translations) {
+            runningCommunicators.removeAll(communicator);
+            communicator->deleteLater();
+            groupFinished(group, translations);
+        });
+    } else {
+        communicator->setPromptWithTemplate(promptTemplate, sourceLang, targetLang, segments[group.segmentIndexes.first()].text);
+        communicator->setContext(group.extraPrompt.trimmed());
+        connect(communicator, &OpenAICommunicator::replyReceived, this, [=](const QString &translation) {
+            runningCommunicators.removeAll(communicator);
+            communicator->deleteLater();
+            groupFinished(group, {translation});
+        });
+    }
+    connect(communicator, &OpenAICommunicator::errorOccurred, this, [=](const QString &errorString) {
+        abortAll(errorString);
+    });
+    communicator->sendRequest();
+}
+
+void TranslationJob::groupFinished(const Group &group, const QStringList &translations) {
+    if (done) {
+        return;
+    }
+    for (int i = 0; i < group.segmentIndexes.size(); ++i) {
+        int index = group.segmentIndexes[i];
+        translatedSegments[index] = translations[i];
+        if (segmentMode) {
+            translationMemory->add(segments[index].text, translations[i], sourceLang, targetLang);
+        }
+    }
+    if (--remainingGroups > 0) {
+        launchGroups();
+        return;
+    }
+    done = true;
+    if (segments.size() == 1) {
+        emit finished(translatedSegments[0]);
+        return;
+    }
+    QString result;
+    for (int i = 0; i < segments.size(); ++i) {
+        result += translatedSegments[i] + segments[i].separator;
+    }
+    emit finished(result);
+}
+
+void TranslationJob::abortAll(const QString &errorString) {
+    if (done) {
+        return;
+    }
+    done = true;
+    for (auto communicator : runningCommunicators) {
+        communicator->disconnect(this);
+        communicator->deleteLater();
+    }
+    runningCommunicators.clear();
+    emit failed(errorString);
+}
@@ -0,0 +1,189 @@
+#include "TranslationMemory.h"
+#include <QFile>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QDir>
+#include <QDebug>
+#include <algorithm>
+
+const quint32 TRANSLATION_MEMORY_MAGIC = 0x494d544d; // "IMTM"
+const quint32 TRANSLATION_MEMORY_VERSION = 1;
+const double MIN_FUZZY_SCORE = 0.6;
+// Trigrams shared by this many entries carry no signal and only slow lookups down
+const int MAX_POSTINGS_PER_TRIGRAM = 5000;
+
+TranslationMemory::TranslationMemory(const QString &filePath_, QObject *parent)
+    : QObject(parent)
+    , filePath(filePath_)
+    , loaded(false)
+    , segmentsSeen(0)
+    , exactMatchesSeen(0)
+    , tokensSaved(0)
+{
+}
+
+QString TranslationMemory::normalize(const QString &text) {
+    return text.simplified();
+}
+
+QString TranslationMemory::languagePairKey(const QString &sourceLang, const QString &targetLang) {
+    return sourceLang.trimmed().toLower() + "->" + targetLang.trimmed().toLower();
+}
+
+QVector<uint> TranslationMemory::trigrams(const QString &normalized) {
+    QString padded = " " + normalized.toLower() + " ";
+    QVector<uint> result;
+    result.reserve(padded.length());
+    for (int i = 0; i + 3 <= padded.length(); ++i) {
+        result.append(static_cast<uint>(qHash(QStringView(padded).mid(i, 3))));
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+void TranslationMemory::ensureLoaded() {
+    if (loaded) {
+        return;
+    }
+    loaded = true;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    QDataStream in(&file);
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if (magic != TRANSLATION_MEMORY_MAGIC || version != TRANSLATION_MEMORY_VERSION) {
+        qDebug() << "Ignoring translation memory with unknown format:" << filePath;
+        return;
+    }
+    while (!in.atEnd() && in.status() == QDataStream::Ok) {
+        QString source, target, languagePair;
+        in >> source >> target >> languagePair;
+        if (in.status() == QDataStream::Ok) {
+            insert(source, target, languagePair);
+        }
+    }
+    qDebug() << "Loaded" << entries.size() << "translation memory entries";
+}
+
+void TranslationMemory::insert(const QString &source, const QString &target, const QString &languagePair) {
+    QString key = languagePair + "\n" + source;
+    auto existing = exactIndex.constFind(key);
+    if (existing != exactIndex.constEnd()) {
+        // Newer translations of the same sentence replace older ones
+        entries[existing.value()].target = target;
+        return;
+    }
+    auto grams = trigrams(source);
+    int id = entries.size();
+    entries.append(Entry{source, target, languagePair, static_cast<int>(grams.size())});
+    exactIndex.insert(key, id);
+    for (uint gram : grams) {
+        trigramIndex[gram].append(id);
+    }
+}
+
+bool TranslationMemory::lookupExact(const QString &source, const QString &sourceLang, const QString &targetLang, QString *target) {
+    ensureLoaded();
+    auto it = exactIndex.constFind(languagePairKey(sourceLang, targetLang) + "\n" + normalize(source));
+    if (it == exactIndex.constEnd()) {
+        return false;
+    }
+    *target = entries[it.value()].target;
+    return true;
+}
+
+QList<TranslationMemory::Match> TranslationMemory::lookupFuzzy(const QString &source, const QString &sourceLang, const QString &targetLang, int maxMatches) {
+    ensureLoaded();
+    QString normalized = normalize(source);
+    QString languagePair = languagePairKey(sourceLang, targetLang);
+    auto grams = trigrams(normalized);
+    if (grams.isEmpty()) {
+        return {};
+    }
+
+    QHash<int, int> sharedCounts;
+    for (uint gram : grams) {
+        auto postings = trigramIndex.constFind(gram);
+        if (postings == trigramIndex.constEnd() || postings->size() > MAX_POSTINGS_PER_TRIGRAM) {
+            continue;
+        }
+        for (int id : *postings) {
+            sharedCounts[id]++;
+        }
+    }
+
+    QList<Match> matches;
+    for (auto it = sharedCounts.constBegin(); it != sharedCounts.constEnd(); ++it) {
+        const Entry &entry = entries[it.key()];
+        if (entry.languagePair != languagePair || entry.source == normalized) {
+            continue;
+        }
+        // Dice coefficient over the sets of character trigrams
+        double score = 2.0 * it.value() / (grams.size() + entry.trigramCount);
+        if (score >= MIN_FUZZY_SCORE) {
+            matches.append(Match{entry.source, entry.target, score});
+        }
+    }
+    std::sort(matches.begin(), matches.end(), [](const Match &a, const Match &b) {
+        return a.score > b.score;
+    });
+    return matches.mid(0, maxMatches);
+}
+
+void TranslationMemory::add(const QString &source, const QString &target, const QString &sourceLang, const QString &targetLang) {
+    ensureLoaded();
+    QString normalized = normalize(source);
+    if (normalized.isEmpty() || target.trimmed().isEmpty()) {
+        return;
+    }
+    QString languagePair = languagePairKey(sourceLang, targetLang);
+    insert(normalized, target, languagePair);
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QFile file(filePath);
+    bool isNew = !file.exists() || file.size() == 0;
+    if (file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        QDataStream out(&file);
+        if (isNew) {
+            out << TRANSLATION_MEMORY_MAGIC << TRANSLATION_MEMORY_VERSION;
+        }
+        out << normalized << target << languagePair;
+        file.close();
+    }
+}
+
+void TranslationMemory::unload() {
+    if (!loaded) {
+        return;
+    }
+    loaded = false;
+    entries = QVector<Entry>();
+    exactIndex = QHash<QString, int>();
+    trigramIndex = QHash<uint, QVector<int>>();
+}
+
+void TranslationMemory::recordUsage(int segments, int exactMatches, int tokens) {
+    segmentsSeen += segments;
+    exactMatchesSeen += exactMatches;
+    tokensSaved += tokens;
+}
+
+int TranslationMemory::size() {
+    ensureLoaded();
+    return entries.size();
+}
+
+int TranslationMemory::totalSegments() const {
+    return segmentsSeen;
+}
+
+int TranslationMemory::totalExactMatches() const {
+    return exactMatchesSeen;
+}
+
+int TranslationMemory::totalTokensSaved() const {
+    return tokensSaved;
+}
@@ -0,0 +1,112 @@
+#include "TranslationQueue.h"
+#include "TranslationJob.h"
+
+TranslationQueue::TranslationQueue(JobFactory jobFactory_, QObject *parent)
+    : QObject(parent)
+    , jobFactory(jobFactory_)
+    , parallelism(3)
+    , running(0)
+    , nextId(1)
+    , delivering(false)
+{
+}
+
+void TranslationQueue::setParallelism(int parallelism_) {
+    parallelism = qMax(1, parallelism_);
+    startNext();
+}
+
+int TranslationQueue::submit(const Entry &entry) {
+    Entry queued = entry;
+    queued.id = nextId++;
+    queued.status = Queued;
+    entries.append(queued);
+    emit statusChanged(queued);
+    startNext();
+    return queued.id;
+}
+
+bool TranslationQueue::isBusy() const {
+    return !entries.isEmpty();
+}
+
+bool TranslationQueue::isPending(const QString &inputText) const {
+    for (const Entry &entry : entries) {
+        if (entry.inputText == inputText && (entry.status == Queued || entry.status == Running)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int TranslationQueue::pendingCount() const {
+    return entries.size();
+}
+
+TranslationQueue::Entry *TranslationQueue::find(int id) {
+    for (Entry &entry : entries) {
+        if (entry.id == id) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void TranslationQueue::startNext() {
+    // Searched again every time, since a job that fails right away changes the list
+    while (running < parallelism) {
+        int index = -1;
+        for (int i = 0; i < entries.size(); i++) {
+            if (entries[i].status == Queued) {
+                index = i;
+                break;
+            }
+        }
+        if (index < 0) {
+            return;
+        }
+        entries[index].status = Running;
+        running++;
+        Entry entry = entries[index];
+        TranslationJob *job = jobFactory(entry);
+        int id = entry.id;
+        connect(job, &TranslationJob::finished, this, [=](const QString &translation) {
+            job->deleteLater();
+            finish(id, Done, translation);
+        });
+        connect(job, &TranslationJob::failed, this, [=](const QString &errorString) {
+            job->deleteLater();
+            finish(id, Failed, errorString);
+        });
+        emit statusChanged(entry);
+        job->start(entry.inputText);
+    }
+}
+
+void TranslationQueue::finish(int id, Status status, const QString &result) {
+    running--;
+    if (Entry *entry = find(id)) {
+        entry->status = status;
+        if (status == Done) {
+            entry->translation = result;
+        } else {
+            entry->errorString = result;
+        }
+        emit statusChanged(*entry);
+    }
+    deliverReady();
+    startNext();
+}
+
+void TranslationQueue::deliverReady() {
+    // Handlers may open dialogs with their own event loop, during which more jobs finish
+    if (delivering) {
+        return;
+    }
+    delivering = true;
+    while (!entries.isEmpty() && (entries.first().status == Done || entries.first().status == Failed)) {
+        Entry entry = entries.takeFirst();
+        emit delivered(entry);
+    }
+    delivering = false;
+}
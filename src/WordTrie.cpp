@@ -0,0 +1,373 @@
+#include "WordTrie.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QRegularExpression>
+#include <QStringDecoder>
+#include <algorithm>
+
+WordTrie::WordTrie()
+    : words(0)
+{
+}
+
+WordTrie WordTrie::build(QStringList wordList) {
+    for (QString &word : wordList) {
+        word = word.toLower();
+    }
+    std::sort(wordList.begin(), wordList.end());
+    wordList.erase(std::unique(wordList.begin(), wordList.end()), wordList.end());
+    wordList.removeAll(QString());
+
+    WordTrie trie;
+    trie.words = wordList.size();
+    trie.buildNode(wordList, 0, wordList.size(), 0);
+    trie.nodes.squeeze();
+    trie.edges.squeeze();
+    return trie;
+}
+
+int WordTrie::buildNode(const QStringList &wordList, int begin, int end, int depth) {
+    int node = nodes.size();
+    nodes.append(Node{0, 0, false});
+    // Sorted input puts the word that ends here first, followed by one run per next character
+    if (begin < end && wordList[begin].size() == depth) {
+        nodes[node].terminal = true;
+        ++begin;
+    }
+    QVector<QPair<int, int>> runs;
+    for (int i = begin; i < end;) {
+        int j = i + 1;
+        while (j < end && wordList[j][depth] == wordList[i][depth]) {
+            ++j;
+        }
+        runs.append({i, j});
+        i = j;
+    }
+    int firstEdge = edges.size();
+    nodes[node].firstEdge = firstEdge;
+    nodes[node].edgeCount = runs.size();
+    for (const auto &run : runs) {
+        edges.append(Edge{wordList[run.first][depth], -1});
+    }
+    for (int r = 0; r < runs.size(); ++r) {
+        edges[firstEdge + r].child = buildNode(wordList, runs[r].first, runs[r].second, depth + 1);
+    }
+    return node;
+}
+
+// One PFX or SFX line of a Hunspell .aff file
+struct AffixRule {
+    QString strip;
+    QString add;
+    QRegularExpression condition; // Empty for ".", which matches every word
+    bool crossProduct;
+};
+
+// The subset of a Hunspell .aff file needed to expand stems into the words they stand for
+struct AffixFile {
+    QByteArray encoding = "UTF-8";
+    QString flagType;
+    QStringList aliases; // AF lines; stems then refer to them by number
+    QString needAffixFlag;
+    QHash<QString, QList<AffixRule>> prefixes;
+    QHash<QString, QList<AffixRule>> suffixes;
+};
+
+static QStringDecoder decoderFor(const QByteArray &encoding) {
+    QStringDecoder decoder(encoding.constData());
+    if (decoder.isValid()) {
+        return decoder;
+    }
+    // Without ICU, Qt only knows Latin-1 among the ISO 8859 family; close enough for the letters dictionaries use
+    return QStringDecoder(encoding.toUpper().startsWith("ISO8859") || encoding.toUpper().startsWith("ISO-8859")
+                          ? QStringConverter::Latin1 : QStringConverter::Utf8);
+}
+
+static QStringList splitFlags(const QString &flags, const AffixFile &affixes) {
+    QString expanded = flags;
+    if (!affixes.aliases.isEmpty()) {
+        bool ok = false;
+        int alias = flags.toInt(&ok);
+        if (ok && alias >= 1 && alias <= affixes.aliases.size()) {
+            expanded = affixes.aliases[alias - 1];
+        }
+    }
+    QStringList result;
+    if (affixes.flagType == "long") {
+        for (int i = 0; i + 1 < expanded.size(); i += 2) {
+            result.append(expanded.mid(i, 2));
+        }
+    } else if (affixes.flagType == "num") {
+        result = expanded.split(',', Qt::SkipEmptyParts);
+    } else {
+        for (QChar ch : expanded) {
+            result.append(QString(ch));
+        }
+    }
+    return result;
+}
+
+static QRegularExpression conditionPattern(const QString &condition, bool suffix) {
+    if (condition == ".") {
+        return QRegularExpression();
+    }
+    // Conditions only use literal characters, "." and bracket sets like [^aeiou]
+    QString pattern;
+    bool inSet = false;
+    for (QChar ch : condition) {
+        if (ch == '[' && !inSet) {
+            inSet = true;
+            pattern += '[';
+        } else if (ch == ']' && inSet) {
+            inSet = false;
+            pattern += ']';
+        } else if (ch == '^' && inSet && pattern.endsWith('[')) {
+            pattern += '^';
+        } else if (ch == '.' && !inSet) {
+            pattern += '.';
+        } else {
+            pattern += QRegularExpression::escape(QString(ch));
+        }
+    }
+    return QRegularExpression(suffix ? "(?:" + pattern + ")$" : "^(?:" + pattern + ")");
+}
+
+static AffixFile loadAffixFile(const QString &filePath) {
+    AffixFile affixes;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return affixes;
+    }
+    QByteArray content = file.readAll();
+    // SET is plain ASCII, so it can be read before the encoding is known
+    static const QRegularExpression setPattern("^SET\\s+(\\S+)", QRegularExpression::MultilineOption);
+    auto setMatch = setPattern.match(QString::fromLatin1(content));
+    if (setMatch.hasMatch()) {
+        affixes.encoding = setMatch.captured(1).toLatin1();
+    }
+    QStringDecoder decoder = decoderFor(affixes.encoding);
+    const QStringList lines = QString(decoder(content)).split('\n');
+
+    QHash<QString, bool> crossProducts;
+    for (const QString &line : lines) {
+        const QStringList fields = line.simplified().split(' ', Qt::SkipEmptyParts);
+        if (fields.isEmpty() || fields[0].startsWith('#')) {
+            continue;
+        }
+        if (fields[0] == "FLAG" && fields.size() > 1) {
+            affixes.flagType = fields[1];
+        } else if (fields[0] == "AF" && fields.size() > 1) {
+            bool isCount = false;
+            fields[1].toInt(&isCount);
+            // The first AF line only holds the number of aliases
+            if (!isCount || fields.size() > 2) {
+                affixes.aliases.append(fields[1]);
+            }
+        } else if (fields[0] == "NEEDAFFIX" && fields.size() > 1) {
+            affixes.needAffixFlag = fields[1];
+        } else if ((fields[0] == "PFX" || fields[0] == "SFX") && fields.size() >= 4) {
+            bool suffix = fields[0] == "SFX";
+            QString key = fields[0] + fields[1];
+            // Header: "SFX flag Y count", rules: "SFX flag strip add condition"
+            if (!crossProducts.contains(key)) {
+                crossProducts.insert(key, fields[2] == "Y");
+                continue;
+            }
+            if (fields.size() < 5) {
+                continue;
+            }
+            AffixRule rule;
+            rule.strip = fields[2] == "0" ? QString() : fields[2];
+            rule.add = fields[3].section('/', 0, 0);
+            if (rule.add == "0") {
+                rule.add.clear();
+            }
+            rule.condition = conditionPattern(fields[4], suffix);
+            rule.crossProduct = crossProducts.value(key);
+            (suffix ? affixes.suffixes : affixes.prefixes)[fields[1]].append(rule);
+        }
+    }
+    return affixes;
+}
+
+static bool applies(const AffixRule &rule, const QString &word, bool suffix) {
+    if (suffix ? !word.endsWith(rule.strip) : !word.startsWith(rule.strip)) {
+        return false;
+    }
+    return rule.condition.pattern().isEmpty() || rule.condition.match(word).hasMatch();
+}
+
+static QString applySuffix(const AffixRule &rule, const QString &word) {
+    return word.left(word.size() - rule.strip.size()) + rule.add;
+}
+
+static QString applyPrefix(const AffixRule &rule, const QString &word) {
+    return rule.add + word.mid(rule.strip.size());
+}
+
+static void expandStem(const QString &stem, const QStringList &flags, const AffixFile &affixes, QStringList &wordList) {
+    if (affixes.needAffixFlag.isEmpty() || !flags.contains(affixes.needAffixFlag)) {
+        wordList.append(stem);
+    }
+    for (const QString &flag : flags) {
+        auto prefixRules = affixes.prefixes.constFind(flag);
+        if (prefixRules != affixes.prefixes.constEnd()) {
+            for (const AffixRule &rule : *prefixRules) {
+                if (applies(rule, stem, false)) {
+                    wordList.append(applyPrefix(rule, stem));
+                }
+            }
+        }
+        auto suffixRules = affixes.suffixes.constFind(flag);
+        if (suffixRules == affixes.suffixes.constEnd()) {
+            continue;
+        }
+        for (const AffixRule &rule : *suffixRules) {
+            if (!applies(rule, stem, true)) {
+                continue;
+            }
+            QString suffixed = applySuffix(rule, stem);
+            wordList.append(suffixed);
+            if (!rule.crossProduct) {
+                continue;
+            }
+            // Words like "unwalked" need both a prefix and a suffix of the same stem
+            for (const QString &prefixFlag : flags) {
+                auto crossRules = affixes.prefixes.constFind(prefixFlag);
+                if (crossRules == affixes.prefixes.constEnd()) {
+                    continue;
+                }
+                for (const AffixRule &prefixRule : *crossRules) {
+                    if (prefixRule.crossProduct && applies(prefixRule, stem, false)) {
+                        wordList.append(applyPrefix(prefixRule, suffixed));
+                    }
+                }
+            }
+        }
+    }
+}
+
+QStringList WordTrie::loadWordList(const QString &filePath) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    // Hunspell .dic files start with a word count and list stems with affix flags after a
+    // slash; the .aff file next to them says how to inflect the stems and how text is encoded
+    bool hunspell = QFileInfo(filePath).suffix() == "dic";
+    AffixFile affixes;
+    if (hunspell) {
+        affixes = loadAffixFile(QFileInfo(filePath).path() + "/" + QFileInfo(filePath).completeBaseName() + ".aff");
+    }
+    QStringDecoder decoder = decoderFor(affixes.encoding);
+    const QStringList lines = QString(decoder(file.readAll())).split('\n');
+
+    QStringList wordList;
+    bool firstLine = true;
+    for (QString line : lines) {
+        line = line.trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        if (!hunspell) {
+            wordList.append(line);
+            continue;
+        }
+        if (firstLine) {
+            firstLine = false;
+            continue;
+        }
+        // Morphological fields may follow the stem after whitespace
+        static const QRegularExpression whitespace("\\s");
+        QString entry = line.section(whitespace, 0, 0);
+        int slash = entry.indexOf('/');
+        if (slash < 0) {
+            wordList.append(entry);
+            continue;
+        }
+        expandStem(entry.left(slash), splitFlags(entry.mid(slash + 1), affixes), affixes, wordList);
+    }
+    return wordList;
+}
+
+int WordTrie::findChild(int node, QChar ch) const {
+    const Node &parent = nodes[node];
+    auto begin = edges.constBegin() + parent.firstEdge;
+    auto end = begin + parent.edgeCount;
+    auto it = std::lower_bound(begin, end, ch, [](const Edge &edge, QChar c) { return edge.ch < c; });
+    return (it != end && it->ch == ch) ? it->child : -1;
+}
+
+bool WordTrie::contains(const QString &word) const {
+    if (nodes.isEmpty()) {
+        return false;
+    }
+    int node = 0;
+    for (QChar ch : word) {
+        node = findChild(node, ch.toLower());
+        if (node < 0) {
+            return false;
+        }
+    }
+    return nodes[node].terminal;
+}
+
+QStringList WordTrie::suggestions(const QString &word, int maxDistance, int maxResults) const {
+    if (nodes.isEmpty()) {
+        return {};
+    }
+    QString lowered = word.toLower();
+    // Levenshtein rows are shared along each trie path, so every prefix is only scored once
+    QVector<int> firstRow(lowered.size() + 1);
+    for (int i = 0; i <= lowered.size(); ++i) {
+        firstRow[i] = i;
+    }
+    QList<QPair<int, QString>> found;
+    QString prefix;
+    const Node &root = nodes[0];
+    for (int e = root.firstEdge; e < root.firstEdge + root.edgeCount; ++e) {
+        prefix.append(edges[e].ch);
+        collectSuggestions(edges[e].child, edges[e].ch, lowered, firstRow, prefix, maxDistance, found);
+        prefix.chop(1);
+    }
+    std::stable_sort(found.begin(), found.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+    QStringList result;
+    for (int i = 0; i < found.size() && result.size() < maxResults; ++i) {
+        result.append(found[i].second);
+    }
+    return result;
+}
+
+void WordTrie::collectSuggestions(int node, QChar ch, const QString &word, const QVector<int> &previousRow,
+                                  QString &prefix, int maxDistance, QList<QPair<int, QString>> &found) const {
+    QVector<int> row(word.size() + 1);
+    row[0] = previousRow[0] + 1;
+    int best = row[0];
+    for (int i = 1; i <= word.size(); ++i) {
+        int substitution = previousRow[i - 1] + (word[i - 1] == ch ? 0 : 1);
+        row[i] = std::min({row[i - 1] + 1, previousRow[i] + 1, substitution});
+        best = std::min(best, row[i]);
+    }
+    if (nodes[node].terminal && row[word.size()] <= maxDistance) {
+        found.append({row[word.size()], prefix});
+    }
+    // No longer word down this branch can get back within range
+    if (best > maxDistance) {
+        return;
+    }
+    const Node &current = nodes[node];
+    for (int e = current.firstEdge; e < current.firstEdge + current.edgeCount; ++e) {
+        prefix.append(edges[e].ch);
+        collectSuggestions(edges[e].child, edges[e].ch, word, row, prefix, maxDistance, found);
+        prefix.chop(1);
+    }
+}
+
+int WordTrie::wordCount() const {
+    return words;
+}
+
+bool WordTrie::isEmpty() const {
+    return words == 0;
+}
@@ -11,54 +11,52 @@ KeyChainClass::KeyChainClass(QObject *parent)
     m_readCredentialJob.setAutoDelete(false);
     m_writeCredentialJob.setAutoDelete(false);
     m_deleteCredentialJob.setAutoDelete(false);
-}
-
-void KeyChainClass::readKey(const QString &key)
-{
-    m_readCredentialJob.setKey(key);
 
-    QObject::connect(&m_readCredentialJob, &QKeychain::ReadPasswordJob::finished, [=]() {
+    // The jobs are reused for every call, so their handlers are connected only once
+    QObject::connect(&m_readCredentialJob, &QKeychain::ReadPasswordJob::finished, this, [this]() {
         if (m_readCredentialJob.error()) {
             emit error(
                     tr("Read key failed: %1").arg(qPrintable(m_readCredentialJob.errorString())));
             return;
         }
-        emit keyRestored(key, m_readCredentialJob.textData());
+        emit keyRestored(m_readCredentialJob.key(), m_readCredentialJob.textData());
     });
 
-    m_readCredentialJob.start();
-}
-
-void KeyChainClass::writeKey(const QString &key, const QString &value)
-{
-    m_writeCredentialJob.setKey(key);
-
-    QObject::connect(&m_writeCredentialJob, &QKeychain::WritePasswordJob::finished, [=]() {
+    QObject::connect(&m_writeCredentialJob, &QKeychain::WritePasswordJob::finished, this, [this]() {
         if (m_writeCredentialJob.error()) {
             emit error(
                     tr("Write key failed: %1").arg(qPrintable(m_writeCredentialJob.errorString())));
             return;
         }
 
-        emit keyStored(key);
+        emit keyStored(m_writeCredentialJob.key());
     });
 
-    m_writeCredentialJob.setTextData(value);
-    m_writeCredentialJob.start();
-}
-
-void KeyChainClass::deleteKey(const QString &key)
-{
-    m_deleteCredentialJob.setKey(key);
-
-    QObject::connect(&m_deleteCredentialJob, &QKeychain::DeletePasswordJob::finished, [=]() {
+    QObject::connect(&m_deleteCredentialJob, &QKeychain::DeletePasswordJob::finished, this, [this]() {
         if (m_deleteCredentialJob.error()) {
             emit error(tr("Delete key failed: %1")
                                .arg(qPrintable(m_deleteCredentialJob.errorString())));
             return;
         }
-        emit keyDeleted(key);
+        emit keyDeleted(m_deleteCredentialJob.key());
     });
+}
+
+void KeyChainClass::readKey(const QString &key)
+{
+    m_readCredentialJob.setKey(key);
+    m_readCredentialJob.start();
+}
+
+void KeyChainClass::writeKey(const QString &key, const QString &value)
+{
+    m_writeCredentialJob.setKey(key);
+    m_writeCredentialJob.setTextData(value);
+    m_writeCredentialJob.start();
+}
 
+void KeyChainClass::deleteKey(const QString &key)
+{
+    m_deleteCredentialJob.setKey(key);
     m_deleteCredentialJob.start();
 }
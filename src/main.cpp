@@ -1,5 +1,12 @@
 #include "mainwindow.h"
 #include "SingleInstance.h"
+#include "ExchangeRecorder.h"
+#include "LanguageIdentifier.h"
+#include "SoakRunner.h"
+#include "BenchRunner.h"
+#include "IdleBenchmark.h"
+#include "SettingsManager.h"
+#include "OpenAICommunicator.h"
 
 #include <QApplication>
 #include <QCoreApplication>
@@ -7,6 +14,11 @@
 #include <QGuiApplication>
 #include <QScreen>
 #include <QRect>
+#include <QCommandLineParser>
+#include <QTextStream>
+
+const int SOAK_STUB_LATENCY_MS = 10;
+const int IDLE_BENCHMARK_SECONDS = 10;
 
 int main(int argc, char *argv[])
 {
@@ -16,6 +28,99 @@ int main(int argc, char *argv[])
     QCoreApplication::setOrganizationDomain("hytromo.github.io");
     QCoreApplication::setApplicationName("immersion");
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption recordOption("record", "Record API exchanges as fixture files into <directory>.", "directory");
+    QCommandLineOption replayOption("replay", "Answer API requests from the fixture files in <directory> instead of the network.", "directory");
+    QCommandLineOption replaySpeedOption("replay-speed", "Replay speed factor, 0 for no delays (default 1).", "factor", "1");
+    QCommandLineOption languageBenchmarkOption("benchmark-language-id", "Print language identification accuracy and speed, then exit.");
+    QCommandLineOption soakOption("soak", "Run <cycles> translate/feedback/report/history cycles against a local stub and check that memory stays flat.", "cycles");
+    parser.addOption(recordOption);
+    parser.addOption(replayOption);
+    parser.addOption(replaySpeedOption);
+    parser.addOption(languageBenchmarkOption);
+    QCommandLineOption benchOption("bench", "Compare latency and token usage of models and prompts on your logged inputs, then exit.");
+    QCommandLineOption benchModelsOption("bench-models", "Comma-separated models to compare (default: the model from the settings).", "models");
+    QCommandLineOption benchTaskOption("bench-task", "Request type to bench: translation, feedback or report (default translation).", "task", "translation");
+    QCommandLineOption benchPromptsOption("bench-prompts", "Comma-separated prompt files to compare (default: the prompt from the settings).", "files");
+    QCommandLineOption benchSamplesOption("bench-samples", "Number of logged inputs, or days for reports, to send (default 20).", "count", "20");
+    QCommandLineOption benchConcurrencyOption("bench-concurrency", "Requests in flight at once (default 2).", "count", "2");
+    QCommandLineOption baseUrlOption("base-url", "OpenAI-compatible API base URL for --bench (default: the one from the settings).", "url");
+    QCommandLineOption idleBenchmarkOption("benchmark-idle", "Compare memory and wakeups of the hidden app before and after idle mode, then exit.");
+    parser.addOption(soakOption);
+    parser.addOption(idleBenchmarkOption);
+    parser.addOption(benchOption);
+    parser.addOption(benchModelsOption);
+    parser.addOption(benchTaskOption);
+    parser.addOption(benchPromptsOption);
+    parser.addOption(benchSamplesOption);
+    parser.addOption(benchConcurrencyOption);
+    parser.addOption(baseUrlOption);
+    parser.process(a);
+
+    if (parser.isSet(languageBenchmarkOption)) {
+        QTextStream(stdout) << LanguageIdentifier::runBenchmark();
+        return 0;
+    }
+
+    if (parser.isSet(soakOption)) {
+        // Separate settings and data, so a soak run never touches the real history and logs
+        QCoreApplication::setApplicationName("immersion-soak");
+        ExchangeRecorder::startStub(SOAK_STUB_LATENCY_MS);
+        MainWindow w;
+        w.show();
+        SoakRunner runner(&w, parser.value(soakOption).toInt());
+        QObject::connect(&runner, &SoakRunner::finished, &a, [&a](bool passed) {
+            a.exit(passed ? 0 : 1);
+        });
+        runner.start();
+        return a.exec();
+    }
+
+    if (parser.isSet(idleBenchmarkOption)) {
+        QCoreApplication::setApplicationName("immersion-soak");
+        ExchangeRecorder::startStub(SOAK_STUB_LATENCY_MS);
+        // Its polling timer is part of what idle mode saves, but a running instance owns it
+        SingleInstance singleInstance;
+        if (singleInstance.tryToRun()) {
+            singleInstance.startListening();
+        } else {
+            QTextStream(stdout) << "Another instance is running, measuring without single instance polling\n";
+        }
+        MainWindow w;
+        QObject::connect(&w, &MainWindow::idleChanged, &singleInstance, &SingleInstance::setIdle);
+        IdleBenchmark benchmark(&w, IDLE_BENCHMARK_SECONDS);
+        QObject::connect(&benchmark, &IdleBenchmark::finished, &a, [&a](bool ok) {
+            a.exit(ok ? 0 : 1);
+        });
+        benchmark.start();
+        return a.exec();
+    }
+
+    if (parser.isSet(replayOption)) {
+        ExchangeRecorder::startReplay(parser.value(replayOption), parser.value(replaySpeedOption).toDouble());
+    } else if (parser.isSet(recordOption)) {
+        ExchangeRecorder::startRecording(parser.value(recordOption));
+    }
+
+    if (parser.isSet(benchOption)) {
+        SettingsManager settings;
+        OpenAICommunicator::setDefaultBaseUrl(parser.isSet(baseUrlOption) ? parser.value(baseUrlOption) : settings.apiBaseUrl());
+        BenchRunner::Config config;
+        config.models = parser.value(benchModelsOption).split(',', Qt::SkipEmptyParts);
+        config.promptFiles = parser.value(benchPromptsOption).split(',', Qt::SkipEmptyParts);
+        config.task = parser.value(benchTaskOption);
+        config.samples = qMax(1, parser.value(benchSamplesOption).toInt());
+        config.concurrency = qMax(1, parser.value(benchConcurrencyOption).toInt());
+        BenchRunner runner(config);
+        QObject::connect(&runner, &BenchRunner::finished, &a, [&a](bool ok) {
+            a.exit(ok ? 0 : 1);
+        });
+        // Queued, so a failure during preparation still reaches the running event loop
+        QMetaObject::invokeMethod(&runner, &BenchRunner::start, Qt::QueuedConnection);
+        return a.exec();
+    }
+
     // Check for single instance
     SingleInstance singleInstance;
     
@@ -30,6 +135,7 @@ int main(int argc, char *argv[])
     
     // Start listening for messages from other instances
     singleInstance.startListening();
+    QObject::connect(&w, &MainWindow::idleChanged, &singleInstance, &SingleInstance::setIdle);
     
     // Connect the signal to bring window to front
     QObject::connect(&singleInstance, &SingleInstance::bringToFrontRequested, [&w]() {
@@ -6,6 +6,22 @@
 #include "SettingsManager.h"
 #include "progressdialog.h"
 #include "FeedbackDialog.h"
+#include "SearchDialog.h"
+#include "DayPickerDialog.h"
+#include "TranslationJob.h"
+#include "TranslationQueue.h"
+#include "StallWatchdog.h"
+#include "MetricsExporter.h"
+#include "Metrics.h"
+#include "Tracer.h"
+#include "ReportScheduler.h"
+#include "ReportBatch.h"
+#include "ClipboardWatcher.h"
+#include "FeedbackSession.h"
+#include "SpellChecker.h"
+#include "LanguageIdentifier.h"
+#include "ExchangeRecorder.h"
+#include "NetworkThread.h"
 
 #include <QInputDialog>
 #include <QMessageBox>
@@ -27,6 +43,7 @@
 #include <QProgressDialog>
 #include <QFile>
 #include <QDate>
+#include <QTime>
 #include <QDialog>
 #include <QVBoxLayout>
 #include <QLineEdit>
@@ -35,6 +52,21 @@
 #include <QUrl>
 #include <QLocale>
 #include <QApplication>
+#include <QStatusBar>
+#include <QMenu>
+#include <QTextCursor>
+#include <climits>
+#include <QStyle>
+#include <QIcon>
+#include <QPixmapCache>
+#include <QShowEvent>
+#include <QHideEvent>
+#include <QListWidget>
+
+// How long a background translation stays in the tray popup
+const int WATCH_POPUP_TIMEOUT_MS = 15000;
+// How long the window stays hidden before memory and wakeups are cut back
+const int IDLE_AFTER_HIDDEN_MS = 60 * 1000;
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -42,6 +74,23 @@ MainWindow::MainWindow(QWidget *parent)
     , keychain(new KeyChainClass(this))
     , appDataManager(new AppDataManager(this))
     , settingsManager(new SettingsManager(this))
+    , modelStats(new ModelStats(this))
+    , modelRouter(new ModelRouter(modelStats, this))
+    , translationMemory(new TranslationMemory(AppDataManager::getAppDataPath() + "/translation-memory.dat", this))
+    , stallWatchdog(nullptr)
+    , metricsExporter(new MetricsExporter(AppDataManager::getAppDataPath(), this))
+    , reportScheduler(new ReportScheduler(appDataManager, settingsManager, this))
+    , reportBatch(new ReportBatch(appDataManager, settingsManager, this))
+    , feedbackSession(new FeedbackSession(this))
+    , spellChecker(nullptr)
+    , languageIdentifier(new LanguageIdentifier(this))
+    , clipboardWatcher(new ClipboardWatcher(languageIdentifier, this))
+    , translationQueue(nullptr)
+    , feedbackRequests(0)
+    , trayIcon(nullptr)
+    , watchGeneration(0)
+    , idleTimer(new QTimer(this))
+    , idle(false)
     , openaiApiKey("")
 {
     ui->setupUi(this);
@@ -52,6 +101,26 @@ MainWindow::MainWindow(QWidget *parent)
     ui->inputText->setPlainText(settingsManager->lastInputText());
     ui->inputText->selectAll();
 
+    spellChecker = new SpellChecker(ui->inputText->document());
+    spellChecker->setEnabled(settingsManager->checkSpelling());
+    spellChecker->setLanguage(ui->sourceLang->text());
+    connect(ui->sourceLang, &QLineEdit::editingFinished, this, [=]() {
+        spellChecker->setLanguage(ui->sourceLang->text());
+    });
+    ui->inputText->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(ui->inputText, &QWidget::customContextMenuRequested, this, &MainWindow::showInputContextMenu);
+
+    translationQueue = new TranslationQueue([=](const TranslationQueue::Entry &entry) {
+        return createTranslationJob(entry);
+    }, this);
+    translationQueue->setParallelism(settingsManager->translationParallelism());
+    connect(translationQueue, &TranslationQueue::statusChanged, this, [=](const TranslationQueue::Entry &entry) {
+        updateQueueItem(entry, false);
+    });
+    connect(translationQueue, &TranslationQueue::delivered, this, &MainWindow::translationDelivered);
+    ui->queueList->hide();
+    connect(ui->queueList, &QListWidget::itemClicked, this, &MainWindow::queueItemClicked);
+
     QShortcut *shortcut = new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_Return), this->ui->inputText);
     connect(shortcut, &QShortcut::activated, this, &MainWindow::on_goButton_clicked);
 
@@ -59,24 +128,83 @@ MainWindow::MainWindow(QWidget *parent)
 
     connect(ui->actionReset_OpenAI_API_key, SIGNAL(triggered()), this, SLOT(actionReset_OpenAI_API_key()));
     connect(ui->actionOpen_corrections_folder, SIGNAL(triggered()), this, SLOT(actionOpenCorrectionsFolder()));
+    connect(ui->actionEditLogArchiveAge, SIGNAL(triggered()), this, SLOT(actionEditLogArchiveAge()));
+    connect(ui->actionTopMistakeCategories, SIGNAL(triggered()), this, SLOT(actionTopMistakeCategories()));
+    connect(ui->actionSearch, SIGNAL(triggered()), this, SLOT(actionSearch()));
+    connect(ui->actionBatchGenerateReports, SIGNAL(triggered()), this, SLOT(actionBatchGenerateReports()));
+    connect(reportBatch, &ReportBatch::submitted, this, [=](int requestCount) {
+        statusBar()->showMessage(QString("Submitted %1 reports as a batch job, they are written as soon as it completes").arg(requestCount));
+    });
+    connect(reportBatch, &ReportBatch::finished, this, [=](int written, int failed) {
+        statusBar()->showMessage(QString("Report batch finished: %1 written, %2 failed").arg(written).arg(failed));
+    });
+    connect(reportBatch, &ReportBatch::errorOccurred, this, [=](const QString &errorString) {
+        QMessageBox::warning(this, "Batch Reports", errorString);
+    });
+    reportScheduler->setReportBatch(reportBatch);
+    connect(reportScheduler, &ReportScheduler::reportReady, this, [=](const QString &dateString) {
+        statusBar()->showMessage("Prepared the report for " + formatDateForDisplay(QDate::fromString(dateString, "yyyy-MM-dd")));
+    });
+    connect(ui->actionEditPrecomputeReportsTime, SIGNAL(triggered()), this, SLOT(actionEditPrecomputeReportsTime()));
+    ui->actionPrecomputeReports->setChecked(settingsManager->precomputeReports());
+    connect(ui->actionPrecomputeReports, &QAction::toggled, this, &MainWindow::actionPrecomputeReportsToggled);
     connect(ui->actionHelp, SIGNAL(triggered()), this, SLOT(actionHelp()));
     connect(ui->actionQuit, SIGNAL(triggered()), this, SLOT(actionQuit()));
     connect(ui->actionEditTranslationModel, SIGNAL(triggered()), this, SLOT(actionEditTranslationModel()));
+    connect(ui->actionEditTranslationModelTiers, SIGNAL(triggered()), this, SLOT(actionEditTranslationModelTiers()));
     connect(ui->actionEditReportsModel, SIGNAL(triggered()), this, SLOT(actionEditReportsModel()));
     connect(ui->actionEditTranslationPrompt, SIGNAL(triggered()), this, SLOT(actionEditTranslationPrompt()));
     connect(ui->actionEditReportPrompt, SIGNAL(triggered()), this, SLOT(actionEditReportPrompt()));
     connect(ui->actionEditFeedbackPrompt, SIGNAL(triggered()), this, SLOT(actionEditFeedbackPrompt()));
     connect(ui->actionEditFeedbackModel, SIGNAL(triggered()), this, SLOT(actionEditFeedbackModel()));
+    connect(ui->actionEditApiBaseUrl, SIGNAL(triggered()), this, SLOT(actionEditApiBaseUrl()));
+    OpenAICommunicator::setDefaultBaseUrl(settingsManager->apiBaseUrl());
+
+    ui->actionHedgeTranslations->setChecked(settingsManager->hedgeTranslations());
+    connect(ui->actionHedgeTranslations, &QAction::toggled, this, &MainWindow::actionHedgeTranslationsToggled);
+    connect(ui->actionEditTranslationParallelism, SIGNAL(triggered()), this, SLOT(actionEditTranslationParallelism()));
+    ui->actionUseTranslationMemory->setChecked(settingsManager->useTranslationMemory());
+    connect(ui->actionUseTranslationMemory, &QAction::toggled, this, &MainWindow::actionUseTranslationMemoryToggled);
+    ui->actionCheckSpelling->setChecked(settingsManager->checkSpelling());
+    connect(ui->actionCheckSpelling, &QAction::toggled, this, &MainWindow::actionCheckSpellingToggled);
+    ui->actionDetectTranslationDirection->setChecked(settingsManager->detectTranslationDirection());
+    connect(ui->actionDetectTranslationDirection, &QAction::toggled, this, &MainWindow::actionDetectTranslationDirectionToggled);
+    ui->actionWatchClipboard->setChecked(settingsManager->watchClipboard());
+    connect(ui->actionWatchClipboard, &QAction::toggled, this, &MainWindow::actionWatchClipboardToggled);
+    connect(clipboardWatcher, &ClipboardWatcher::textCaptured, this, &MainWindow::translateCapturedText);
+    connect(ui->sourceLang, &QLineEdit::editingFinished, clipboardWatcher, [=]() {
+        clipboardWatcher->setLanguages({ui->sourceLang->text(), ui->targetLang->text()});
+    });
+    connect(ui->targetLang, &QLineEdit::editingFinished, clipboardWatcher, [=]() {
+        clipboardWatcher->setLanguages({ui->sourceLang->text(), ui->targetLang->text()});
+    });
+    ui->actionDetectUiStalls->setChecked(settingsManager->stallWatchdogEnabled());
+    connect(ui->actionDetectUiStalls, &QAction::toggled, this, &MainWindow::actionDetectUiStallsToggled);
+    connect(ui->actionOpenStallReport, SIGNAL(triggered()), this, SLOT(actionOpenStallReport()));
+    ui->actionExportMetrics->setChecked(settingsManager->metricsExportEnabled());
+    connect(ui->actionExportMetrics, &QAction::toggled, this, &MainWindow::actionExportMetricsToggled);
+    connect(ui->actionRecordTrace, &QAction::toggled, this, &MainWindow::actionRecordTraceToggled);
     
     // Connect to application shutdown signal for graceful shutdown
     connect(qApp, &QApplication::aboutToQuit, this, &MainWindow::saveSettings);
     
     setupHistoryMenu();
-    setupGenerateReportMenu();
+    // Built from the day index each time it opens, so it never shows yesterday's idea of "today"
+    connect(ui->menuGenerateReport, &QMenu::aboutToShow, this, &MainWindow::setupGenerateReportMenu);
+    archiveOldLogsInBackground();
+    actionDetectUiStallsToggled(settingsManager->stallWatchdogEnabled());
+    actionExportMetricsToggled(settingsManager->metricsExportEnabled());
+    reportScheduler->setEnabled(settingsManager->precomputeReports());
+    actionWatchClipboardToggled(settingsManager->watchClipboard());
+
+    idleTimer->setSingleShot(true);
+    idleTimer->setInterval(IDLE_AFTER_HIDDEN_MS);
+    connect(idleTimer, &QTimer::timeout, this, &MainWindow::enterIdleMode);
 }
 
 MainWindow::~MainWindow()
 {
+    delete stallWatchdog;
     delete ui;
 }
 
@@ -92,9 +220,18 @@ void MainWindow::saveSettings()
 void MainWindow::retrieveOpenAIApiKey()
 {
     static const QString OPENAI_API_KEY_KEYCHAIN_KEY = "hytromo/immersion/openai_api_key";
+    // Replayed and stubbed runs never send the key anywhere, so don't ask for it
+    if (ExchangeRecorder::isOffline()) {
+        openaiApiKey = "offline";
+        reportScheduler->setApiKey(openaiApiKey);
+        reportBatch->setApiKey(openaiApiKey);
+        return;
+    }
     connect(keychain, &KeyChainClass::keyRestored, this,
             [=](const QString &key, const QString &value) {
                 openaiApiKey = value;
+                reportScheduler->setApiKey(value);
+                reportBatch->setApiKey(value);
             });
     connect(keychain, &KeyChainClass::error, this,
             [=](const QString &errorMessage) {
@@ -110,6 +247,8 @@ void MainWindow::requestApiKeyPopup()
     ApiKeyDialog dialog(this);
     if (dialog.exec() == QDialog::Accepted) {
         openaiApiKey = dialog.getApiKey();
+        reportScheduler->setApiKey(openaiApiKey);
+        reportBatch->setApiKey(openaiApiKey);
         if (!openaiApiKey.isEmpty()) {
             keychain->writeKey(OPENAI_API_KEY_KEYCHAIN_KEY, openaiApiKey);
         }
@@ -129,11 +268,83 @@ void MainWindow::actionOpenCorrectionsFolder()
     });
 }
 
+void MainWindow::archiveOldLogsInBackground()
+{
+    int maxAgeDays = settingsManager->logArchiveAfterDays();
+    (void)QtConcurrent::run([maxAgeDays]() {
+        AppDataManager::archiveOldLogs(maxAgeDays);
+    });
+}
+
+void MainWindow::actionEditLogArchiveAge()
+{
+    bool ok = false;
+    int days = QInputDialog::getInt(this, "Archive Old Logs",
+                                    "Compress logs and reports older than this many days (0 keeps everything uncompressed):",
+                                    settingsManager->logArchiveAfterDays(), 0, 3650, 1, &ok);
+    if (ok) {
+        settingsManager->setLogArchiveAfterDays(days);
+        settingsManager->sync();
+        archiveOldLogsInBackground();
+    }
+}
+
+void MainWindow::actionPrecomputeReportsToggled(bool checked)
+{
+    settingsManager->setPrecomputeReports(checked);
+    settingsManager->sync();
+    reportScheduler->setEnabled(checked);
+}
+
+void MainWindow::actionEditPrecomputeReportsTime()
+{
+    bool ok = false;
+    QString time = QInputDialog::getText(this, "Prepare Reports",
+                                         "Time of day (HH:mm) to prepare missing reports, or empty to only do it while you are away:",
+                                         QLineEdit::Normal, settingsManager->precomputeReportsTime(), &ok).trimmed();
+    if (!ok) {
+        return;
+    }
+    if (!time.isEmpty() && !QTime::fromString(time, "HH:mm").isValid()) {
+        QMessageBox::warning(this, "Prepare Reports", "Please enter the time as HH:mm, for example 03:30.");
+        return;
+    }
+    settingsManager->setPrecomputeReportsTime(time);
+    settingsManager->sync();
+}
+
+void MainWindow::actionSearch()
+{
+    auto dialog = new SearchDialog(appDataManager->searchIndex(), this);
+    dialog->show();
+}
+
+void MainWindow::actionTopMistakeCategories()
+{
+    QDate today = QDate::currentDate();
+    auto categories = appDataManager->mistakeStore()->topCategories(today.addMonths(-6), today);
+    if (categories.isEmpty()) {
+        QMessageBox::information(this, "Top Mistake Categories", "No structured reports from the last 6 months yet.");
+        return;
+    }
+    int total = 0;
+    for (const auto &category : categories) {
+        total += category.second;
+    }
+    QString text = "Most frequent mistakes over the last 6 months:\n\n";
+    for (const auto &category : categories) {
+        text += QString("%1: %2 (%3%)\n").arg(category.first).arg(category.second).arg(100 * category.second / total);
+    }
+    QMessageBox::information(this, "Top Mistake Categories", text);
+}
+
 void MainWindow::actionReset_OpenAI_API_key()
 {
     static const QString OPENAI_API_KEY_KEYCHAIN_KEY = "hytromo/immersion/openai_api_key";
     keychain->deleteKey(OPENAI_API_KEY_KEYCHAIN_KEY);
     openaiApiKey = "";
+    reportScheduler->setApiKey(openaiApiKey);
+    reportBatch->setApiKey(openaiApiKey);
     requestApiKeyPopup();
 }
 
@@ -159,7 +370,11 @@ void MainWindow::actionGenerateMistakesReport()
     auto openaiCommunicator = new OpenAICommunicator(openaiApiKey, this);
     progress->show();
 
-    auto fileContent = appDataManager->getTodaysFileContent();
+    QString fileContent;
+    {
+        TRACE_SCOPE("report.read_log");
+        fileContent = appDataManager->getTodaysFileContent();
+    }
     if (fileContent.isEmpty()) {
         cleanupProgressAndCommunicator(progress, openaiCommunicator);
         QMessageBox::warning(this, "Error", "Could not open today's file.");
@@ -169,85 +384,328 @@ void MainWindow::actionGenerateMistakesReport()
     QString promptTemplate = settingsManager->reportPrompt();
     QString prompt = promptTemplate.replace("%sourceLang", sourceLang);
     openaiCommunicator->setModelName(settingsManager->reportModelName());
-    openaiCommunicator->setPromptRaw(prompt + "\n\n" + fileContent);
+    openaiCommunicator->setPromptRaw(prompt);
+    openaiCommunicator->setInputText(fileContent);
+    openaiCommunicator->setResponseFormat(ResponseFormat::MistakeReport);
+    openaiCommunicator->setTask(Metrics::TaskReport);
+    Tracer::asyncBegin("report.pipeline", reinterpret_cast<quintptr>(openaiCommunicator));
     openaiCommunicator->sendRequest();
-    connect(openaiCommunicator, &OpenAICommunicator::replyReceived, this, [=](const QString &report) mutable {
+    connect(openaiCommunicator, &OpenAICommunicator::structuredReplyReceived, this, [=](const QJsonObject &result) mutable {
+        TRACE_SCOPE("report.write");
+        Tracer::asyncEnd("report.pipeline", reinterpret_cast<quintptr>(openaiCommunicator));
         cleanupProgressAndCommunicator(progress, openaiCommunicator);
-        appDataManager->writeMistakesReport(report);
+        appDataManager->writeMistakesReport(MistakeStore::recordsFromJson(result["mistakes"].toArray()),
+                                            QDate::currentDate().toString("yyyy-MM-dd"));
     });
     connect(openaiCommunicator, &OpenAICommunicator::errorOccurred, this, [=](const QString &errorString) mutable {
+        Tracer::asyncEnd("report.pipeline", reinterpret_cast<quintptr>(openaiCommunicator));
         cleanupProgressAndCommunicator(progress, openaiCommunicator);
         QMessageBox::warning(this, "Network Error", errorString);
     });
 }
 
-void MainWindow::on_goButton_clicked()
+void MainWindow::actionBatchGenerateReports()
 {
-    if (!ui->goButton->isEnabled()) {
+    if (openaiApiKey.isEmpty()) {
+        QMessageBox::warning(this, "Error", "OpenAI API key is missing.");
         return;
     }
+    if (reportBatch->isRunning()) {
+        QMessageBox::information(this, "Batch Reports", "A report batch is already running, its reports are written as soon as it completes.");
+        return;
+    }
+    QStringList dateStrings;
+    QString today = QDate::currentDate().toString("yyyy-MM-dd");
+    for (const QString &path : AppDataManager::recentDayFiles(INT_MAX)) {
+        QString dateString = QFileInfo(path).completeBaseName();
+        // Today is still being written to, and reports being prepared right now would be duplicated
+        if (dateString != today && !reportScheduler->isPending(dateString)
+            && !appDataManager->hasUpToDateReport(dateString)) {
+            dateStrings.append(dateString);
+        }
+    }
+    if (dateStrings.isEmpty()) {
+        QMessageBox::information(this, "Batch Reports", "Every finished day already has an up-to-date report.");
+        return;
+    }
+    auto answer = QMessageBox::question(this, "Batch Reports",
+        QString("Generate reports for %1 days (%2 to %3) as one batch job?\n\n"
+                "Batch jobs are cheaper but can take up to 24 hours. The reports are written to the reports folder when the job completes, also after a restart.")
+            .arg(dateStrings.size()).arg(dateStrings.last()).arg(dateStrings.first()));
+    if (answer == QMessageBox::Yes) {
+        reportBatch->submit(dateStrings);
+    }
+}
+
+void MainWindow::on_goButton_clicked()
+{
     if (openaiApiKey.isEmpty()) {
         QMessageBox::warning(this, "Error", "OpenAI API key is missing.");
         return;
     }
-    ui->goButton->setDisabled(true);
+    TRACE_SCOPE("translate.click");
     auto inputText = ui->inputText->toPlainText();
+    if (translationQueue->isPending(inputText)) {
+        statusBar()->showMessage("This text is already being translated");
+        return;
+    }
     auto sourceLang = ui->sourceLang->text();
     auto targetLang = ui->targetLang->text();
     bool quickFeedback = ui->quickFeedbackCheckBox->isChecked();
+
+    // Text pasted in the target language is translated the other way round
+    bool reversed = false;
+    if (settingsManager->detectTranslationDirection()) {
+        TRACE_SCOPE("translate.detect_language");
+        if (languageIdentifier->identify(inputText, {sourceLang, targetLang}) == targetLang) {
+            std::swap(sourceLang, targetLang);
+            reversed = true;
+        }
+    }
     
     // Add message to history
-    addMessageToHistory(inputText);
-    
-    auto openaiCommunicator = new OpenAICommunicator(openaiApiKey, this);
-    openaiCommunicator->setModelName(settingsManager->translationModelName());
-    openaiCommunicator->setPromptWithTemplate(settingsManager->translationPrompt(), sourceLang, targetLang, inputText);
-    openaiCommunicator->sendRequest();
+    {
+        TRACE_SCOPE("translate.history");
+        addMessageToHistory(inputText);
+    }
     
-    connect(openaiCommunicator, &OpenAICommunicator::replyReceived, this, [=](const QString &translation) {
-        auto clipboard = QGuiApplication::clipboard();
-        clipboard->setText(translation);
-        appDataManager->writeTranslationLog(ui->inputText->toPlainText());
-        
-        // If quick feedback is enabled, request feedback
-        if (quickFeedback) {
-            auto feedbackCommunicator = new OpenAICommunicator(openaiApiKey, this);
-            feedbackCommunicator->setModelName(settingsManager->feedbackModelName());
-            
-            QString feedbackPromptTemplate = settingsManager->feedbackPrompt();
-            QString feedbackPrompt = feedbackPromptTemplate.replace("%sourceLang", sourceLang);
-            feedbackCommunicator->setPromptRaw(feedbackPrompt + "\n\n" + inputText);
-            feedbackCommunicator->sendRequest();
-            
-            connect(feedbackCommunicator, &OpenAICommunicator::replyReceived, this, [=](const QString &feedback) {
-                ui->goButton->setEnabled(true);
-                FeedbackDialog dialog(feedback, this);
-                dialog.exec();
-                this->hide();
-                feedbackCommunicator->deleteLater();
-            });
-            
-            connect(feedbackCommunicator, &OpenAICommunicator::errorOccurred, this, [=](const QString &errorString) {
-                ui->goButton->setEnabled(true);
-                QMessageBox::warning(this, "Feedback Error", "Failed to get feedback: " + errorString);
-                this->hide();
-                feedbackCommunicator->deleteLater();
-            });
+    // Route by input size and observed model health when tiers are configured
+    QString modelName;
+    {
+        TRACE_SCOPE("translate.settings_and_routing");
+        modelName = settingsManager->translationModelName();
+        modelRouter->setTiers(settingsManager->translationModelTiers());
+        modelRouter->setLatencyBudgetMs(settingsManager->translationLatencyBudgetMs());
+        auto routedModel = modelRouter->route(inputText);
+        if (!routedModel.isEmpty()) {
+            modelName = routedModel;
+        }
+    }
+    qDebug() << "Translating with" << modelName;
+
+    // A submission into an empty queue starts a new list, which only shows up once a second one joins
+    if (!translationQueue->isBusy()) {
+        ui->queueList->clear();
+        ui->queueList->hide();
+    } else {
+        ui->queueList->show();
+    }
+
+    TranslationQueue::Entry entry;
+    entry.inputText = inputText;
+    entry.sourceLang = sourceLang;
+    entry.targetLang = targetLang;
+    entry.modelName = modelName;
+    entry.reversed = reversed;
+    entry.quickFeedback = quickFeedback;
+    {
+        TRACE_SCOPE("translate.start_job");
+        translationQueue->submit(entry);
+    }
+    if (translationQueue->pendingCount() > 1) {
+        statusBar()->showMessage(QString("Queued, %1 translations in progress").arg(translationQueue->pendingCount()));
+    }
+    // The next message can be typed straight over this one
+    ui->inputText->selectAll();
+}
+
+TranslationJob *MainWindow::createTranslationJob(const TranslationQueue::Entry &entry)
+{
+    auto translationJob = new TranslationJob(openaiApiKey, this);
+    Tracer::asyncBegin("translate.pipeline", reinterpret_cast<quintptr>(translationJob), entry.modelName);
+    translationJob->setModelName(entry.modelName);
+    translationJob->setModelStats(modelStats);
+    translationJob->setHedgingEnabled(settingsManager->hedgeTranslations());
+    if (settingsManager->useTranslationMemory()) {
+        translationJob->setTranslationMemory(translationMemory);
+    }
+    translationJob->setPromptTemplate(settingsManager->translationPrompt(), entry.sourceLang, entry.targetLang);
+
+    int id = entry.id;
+    QString modelName = entry.modelName;
+    QString direction = entry.reversed ? QString(" (detected %1, translated to %2)").arg(entry.sourceLang, entry.targetLang) : QString();
+    // The job is gone by the time its result is delivered, so its summary is kept until then
+    connect(translationJob, &TranslationJob::finished, this, [=]() {
+        if (settingsManager->useTranslationMemory()) {
+            translationSummaries[id] = QString("Translated with %1, %2 of %3 sentences from memory (~%4 tokens saved)")
+                                           .arg(modelName).arg(translationJob->memoryMatchCount())
+                                           .arg(translationJob->segmentCount()).arg(translationJob->tokensSaved()) + direction;
+        } else if (translationJob->chunkCount() > 1) {
+            translationSummaries[id] = QString("Translated with %1 in %2 parallel chunks").arg(modelName).arg(translationJob->chunkCount()) + direction;
         } else {
-            ui->goButton->setEnabled(true);
-            this->hide();
+            translationSummaries[id] = "Translated with " + modelName + direction;
         }
-        
-        openaiCommunicator->deleteLater();
+        Tracer::asyncEnd("translate.pipeline", reinterpret_cast<quintptr>(translationJob));
     });
-    
-    connect(openaiCommunicator, &OpenAICommunicator::errorOccurred, this, [=](const QString &errorString) {
-        ui->goButton->setEnabled(true);
-        QMessageBox::warning(this, "Network Error", errorString);
-        openaiCommunicator->deleteLater();
+    connect(translationJob, &TranslationJob::failed, this, [=]() {
+        Tracer::asyncEnd("translate.pipeline", reinterpret_cast<quintptr>(translationJob));
+    });
+    return translationJob;
+}
+
+void MainWindow::translationDelivered(const TranslationQueue::Entry &entry)
+{
+    StallWatchdog::Operation operation("MainWindow::translationDelivered");
+    TRACE_SCOPE("translate.finished");
+    QString summary = translationSummaries.take(entry.id);
+    updateQueueItem(entry, true);
+    if (entry.status == TranslationQueue::Failed) {
+        statusBar()->showMessage("Translation with " + entry.modelName + " failed");
+        QMessageBox::warning(this, "Network Error", entry.errorString);
+        return;
+    }
+    {
+        TRACE_SCOPE("translate.clipboard");
+        auto clipboard = QGuiApplication::clipboard();
+        clipboard->setText(entry.translation);
+    }
+    languageIdentifier->learn(entry.sourceLang, entry.inputText);
+    languageIdentifier->learn(entry.targetLang, entry.translation);
+    statusBar()->showMessage(summary);
+    // Only text written in the language being learnt belongs in the logs and gets feedback
+    if (!entry.reversed) {
+        TRACE_SCOPE("translate.log_write");
+        appDataManager->writeTranslationLog(entry.inputText);
+    }
+
+    // If quick feedback is enabled, request feedback
+    if (entry.quickFeedback && !entry.reversed) {
+        requestFeedback(entry.inputText, entry.sourceLang);
+    } else {
+        TRACE_SCOPE("translate.hide_window");
+        hideWhenDone();
+    }
+}
+
+void MainWindow::updateQueueItem(const TranslationQueue::Entry &entry, bool delivered)
+{
+    QListWidgetItem *item = nullptr;
+    for (int i = 0; i < ui->queueList->count(); i++) {
+        if (ui->queueList->item(i)->data(Qt::UserRole).toInt() == entry.id) {
+            item = ui->queueList->item(i);
+            break;
+        }
+    }
+    if (!item) {
+        item = new QListWidgetItem(ui->queueList);
+        item->setData(Qt::UserRole, entry.id);
+        item->setToolTip(entry.inputText);
+    }
+    QString input = entry.inputText.simplified();
+    switch (entry.status) {
+        case TranslationQueue::Queued:
+            item->setText("Queued: " + input);
+            break;
+        case TranslationQueue::Running:
+            item->setText("Translating: " + input);
+            break;
+        case TranslationQueue::Done:
+            if (delivered) {
+                item->setText(entry.translation.simplified());
+                item->setData(Qt::UserRole + 1, entry.translation);
+            } else {
+                item->setText("Waiting for earlier translations: " + input);
+            }
+            break;
+        case TranslationQueue::Failed:
+            item->setText("Failed: " + input);
+            item->setToolTip(entry.errorString);
+            break;
+    }
+}
+
+void MainWindow::queueItemClicked(QListWidgetItem *item)
+{
+    QString translation = item->data(Qt::UserRole + 1).toString();
+    if (!translation.isEmpty()) {
+        QGuiApplication::clipboard()->setText(translation);
+        statusBar()->showMessage("Copied to the clipboard");
+    }
+}
+
+void MainWindow::hideWhenDone()
+{
+    // Results of several queued translations stay listed until the window is closed
+    if (isBusy() || !ui->queueList->isHidden()) {
+        return;
+    }
+    hide();
+}
+
+bool MainWindow::isBusy() const
+{
+    return translationQueue->isBusy() || feedbackRequests > 0 || !queuedFeedback.isEmpty();
+}
+
+void MainWindow::requestFeedback(const QString &inputText, const QString &sourceLang)
+{
+    // The session diffs against the previous submission, so one request runs at a time
+    if (feedbackRequests > 0) {
+        queuedFeedback.append({inputText, sourceLang});
+        return;
+    }
+    TRACE_SCOPE("feedback.request");
+    QString feedbackPromptTemplate = settingsManager->feedbackPrompt();
+    QString feedbackPrompt = feedbackPromptTemplate.replace("%sourceLang", sourceLang);
+    auto feedbackModel = settingsManager->feedbackModelName();
+    feedbackSession->setContext(feedbackModel + "\n" + feedbackPrompt);
+
+    // Only sentences added or edited since the last submission go to the feedback model
+    QStringList changed = feedbackSession->changedSentences(inputText);
+    if (changed.isEmpty()) {
+        showFeedback(feedbackSession->merge({}, {}));
+        return;
+    }
+    qDebug() << "Requesting feedback for" << changed.size() << "changed sentences";
+
+    auto feedbackCommunicator = new OpenAICommunicator(openaiApiKey, this);
+    feedbackCommunicator->setModelName(feedbackModel);
+    feedbackCommunicator->setTask(Metrics::TaskFeedback);
+    feedbackCommunicator->setPromptRaw(feedbackPrompt);
+    feedbackCommunicator->setSegments(changed);
+    feedbackCommunicator->setResponseFormat(ResponseFormat::SentenceFeedback);
+    Tracer::asyncBegin("feedback.pipeline", reinterpret_cast<quintptr>(feedbackCommunicator));
+    feedbackRequests++;
+    feedbackCommunicator->sendRequest();
+
+    connect(feedbackCommunicator, &OpenAICommunicator::segmentsReceived, this, [=](const QStringList &feedback) {
+        StallWatchdog::Operation operation("MainWindow::feedbackReceived");
+        Tracer::asyncEnd("feedback.pipeline", reinterpret_cast<quintptr>(feedbackCommunicator));
+        feedbackRequests--;
+        showFeedback(feedbackSession->merge(changed, feedback));
+        feedbackCommunicator->deleteLater();
+        requestQueuedFeedback();
+    });
+
+    connect(feedbackCommunicator, &OpenAICommunicator::errorOccurred, this, [=](const QString &errorString) {
+        Tracer::asyncEnd("feedback.pipeline", reinterpret_cast<quintptr>(feedbackCommunicator));
+        feedbackRequests--;
+        feedbackCommunicator->deleteLater();
+        requestQueuedFeedback();
+        QMessageBox::warning(this, "Feedback Error", "Failed to get feedback: " + errorString);
+        hideWhenDone();
     });
 }
 
+void MainWindow::requestQueuedFeedback()
+{
+    // Texts whose sentences all have feedback already are answered without a request
+    while (feedbackRequests == 0 && !queuedFeedback.isEmpty()) {
+        auto next = queuedFeedback.takeFirst();
+        requestFeedback(next.first, next.second);
+    }
+}
+
+void MainWindow::showFeedback(const QList<SentenceFeedback> &feedback)
+{
+    TRACE_SCOPE("feedback.show_dialog");
+    // Shown without a nested event loop so other replies keep being handled meanwhile
+    auto dialog = new FeedbackDialog(feedback, this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    connect(dialog, &QDialog::finished, this, &MainWindow::hideWhenDone);
+    dialog->open();
+}
+
 void MainWindow::actionHelp()
 {
     QUrl url("https://github.com/hytromo/immersion");
@@ -271,6 +729,20 @@ void MainWindow::actionEditTranslationModel()
     }
 }
 
+void MainWindow::actionEditTranslationModelTiers()
+{
+    QString currentTiers = settingsManager->translationModelTiers();
+    bool ok = false;
+    QString newTiers = QInputDialog::getText(this, "Edit Translation Model Tiers",
+                                           "Comma separated models, each with an optional max token count\n"
+                                           "(e.g. gpt-4o-mini:400, gpt-4.1). Leave empty to always use the translation model:",
+                                           QLineEdit::Normal, currentTiers, &ok);
+    if (ok && newTiers != currentTiers) {
+        settingsManager->setTranslationModelTiers(newTiers.trimmed());
+        settingsManager->sync();
+    }
+}
+
 void MainWindow::actionEditReportsModel()
 {
     QString currentModel = settingsManager->reportModelName();
@@ -337,8 +809,277 @@ void MainWindow::actionEditFeedbackModel()
     }
 }
 
+void MainWindow::actionEditApiBaseUrl()
+{
+    QString currentUrl = settingsManager->apiBaseUrl();
+    QString newUrl = QInputDialog::getText(this, "Edit API Base URL",
+                                           "Base URL of the OpenAI-compatible API (ending in /v1):",
+                                           QLineEdit::Normal, currentUrl).trimmed();
+    if (!newUrl.isEmpty() && newUrl != currentUrl) {
+        settingsManager->setApiBaseUrl(newUrl);
+        settingsManager->sync();
+        OpenAICommunicator::setDefaultBaseUrl(newUrl);
+    }
+}
+
+void MainWindow::actionHedgeTranslationsToggled(bool checked)
+{
+    settingsManager->setHedgeTranslations(checked);
+    settingsManager->sync();
+}
+
+void MainWindow::actionEditTranslationParallelism()
+{
+    bool ok = false;
+    int parallelism = QInputDialog::getInt(this, "Parallel Translations",
+                                           "Translate at most this many submitted messages at the same time:",
+                                           settingsManager->translationParallelism(), 1, 16, 1, &ok);
+    if (ok) {
+        settingsManager->setTranslationParallelism(parallelism);
+        settingsManager->sync();
+        translationQueue->setParallelism(parallelism);
+    }
+}
+
+void MainWindow::actionUseTranslationMemoryToggled(bool checked)
+{
+    settingsManager->setUseTranslationMemory(checked);
+    settingsManager->sync();
+}
+
+void MainWindow::actionDetectTranslationDirectionToggled(bool checked)
+{
+    settingsManager->setDetectTranslationDirection(checked);
+    settingsManager->sync();
+}
+
+void MainWindow::actionWatchClipboardToggled(bool checked)
+{
+    settingsManager->setWatchClipboard(checked);
+    settingsManager->sync();
+    clipboardWatcher->setLanguages({ui->sourceLang->text(), ui->targetLang->text()});
+    clipboardWatcher->setMaxChars(settingsManager->clipboardWatchMaxChars());
+    clipboardWatcher->setEnabled(checked);
+    if (!checked) {
+        if (trayIcon) {
+            trayIcon->hide();
+        }
+        return;
+    }
+    if (!QSystemTrayIcon::isSystemTrayAvailable()) {
+        statusBar()->showMessage("No system tray found, background translations are shown in the status bar");
+        return;
+    }
+    if (!trayIcon) {
+        QIcon icon = windowIcon().isNull() ? style()->standardIcon(QStyle::SP_MessageBoxInformation) : windowIcon();
+        trayIcon = new QSystemTrayIcon(icon, this);
+        trayIcon->setToolTip("Immersion is translating copied text");
+        // Clicking the popup copies the translation, clicking the icon brings the window back
+        connect(trayIcon, &QSystemTrayIcon::messageClicked, this, [=]() {
+            QGuiApplication::clipboard()->setText(lastWatchTranslation);
+        });
+        connect(trayIcon, &QSystemTrayIcon::activated, this, [=](QSystemTrayIcon::ActivationReason reason) {
+            if (reason == QSystemTrayIcon::Trigger) {
+                showNormal();
+                raise();
+                activateWindow();
+            }
+        });
+    }
+    trayIcon->show();
+}
+
+void MainWindow::translateCapturedText(const QString &text)
+{
+    // Copying inside the window is part of the normal flow, and there is nothing to send without a key
+    if (isActiveWindow() || openaiApiKey.isEmpty()) {
+        return;
+    }
+    QString sourceLang = ui->sourceLang->text();
+    QString targetLang = ui->targetLang->text();
+    if (languageIdentifier->identify(text, {sourceLang, targetLang}) == targetLang) {
+        std::swap(sourceLang, targetLang);
+    }
+    int generation = ++watchGeneration;
+    auto translationJob = new TranslationJob(openaiApiKey, this);
+    translationJob->setModelName(settingsManager->translationModelName());
+    translationJob->setModelStats(modelStats);
+    // Nobody asked for this one, so it must not hold back translations or reports
+    translationJob->setPriority(RequestScheduler::PriorityBackground);
+    if (settingsManager->useTranslationMemory()) {
+        translationJob->setTranslationMemory(translationMemory);
+    }
+    translationJob->setPromptTemplate(settingsManager->translationPrompt(), sourceLang, targetLang);
+    connect(translationJob, &TranslationJob::finished, this, [=](const QString &translation) {
+        translationJob->deleteLater();
+        // A newer copy has replaced this one
+        if (generation != watchGeneration) {
+            return;
+        }
+        lastWatchTranslation = translation;
+        if (trayIcon && trayIcon->isVisible()) {
+            trayIcon->showMessage(sourceLang + " to " + targetLang, translation, QSystemTrayIcon::NoIcon, WATCH_POPUP_TIMEOUT_MS);
+        } else {
+            statusBar()->showMessage(translation, WATCH_POPUP_TIMEOUT_MS);
+        }
+    });
+    connect(translationJob, &TranslationJob::failed, this, [=](const QString &errorString) {
+        // Nobody asked for this translation, so failures stay quiet
+        qDebug() << "Background translation of copied text failed:" << errorString;
+        translationJob->deleteLater();
+    });
+    translationJob->start(text);
+}
+
+void MainWindow::actionCheckSpellingToggled(bool checked)
+{
+    settingsManager->setCheckSpelling(checked);
+    settingsManager->sync();
+    spellChecker->setEnabled(checked);
+}
+
+void MainWindow::showInputContextMenu(const QPoint &position)
+{
+    QMenu *menu = ui->inputText->createStandardContextMenu(position);
+    menu->setAttribute(Qt::WA_DeleteOnClose);
+
+    QTextCursor cursor = ui->inputText->cursorForPosition(position);
+    cursor.select(QTextCursor::WordUnderCursor);
+    QString word = cursor.selectedText();
+    if (!word.isEmpty() && spellChecker->isMisspelled(word)) {
+        QStringList suggestions = spellChecker->suggestions(word);
+        QAction *first = menu->actions().value(0);
+        if (suggestions.isEmpty()) {
+            QAction *none = new QAction("No suggestions", menu);
+            none->setEnabled(false);
+            menu->insertAction(first, none);
+        }
+        for (const QString &suggestion : suggestions) {
+            // Keep the capitalisation of the word being replaced
+            QString replacement = word[0].isUpper() ? suggestion.left(1).toUpper() + suggestion.mid(1) : suggestion;
+            QAction *action = new QAction(replacement, menu);
+            connect(action, &QAction::triggered, this, [=]() mutable {
+                cursor.insertText(replacement);
+            });
+            menu->insertAction(first, action);
+        }
+        menu->insertSeparator(first);
+    }
+    menu->popup(ui->inputText->mapToGlobal(position));
+}
+
+void MainWindow::actionDetectUiStallsToggled(bool checked)
+{
+    if (checked != settingsManager->stallWatchdogEnabled()) {
+        settingsManager->setStallWatchdogEnabled(checked);
+        settingsManager->sync();
+    }
+    if (checked && !stallWatchdog) {
+        stallWatchdog = new StallWatchdog(AppDataManager::getAppDataPath() + "/stall-report.txt");
+        stallWatchdog->setThresholdMs(settingsManager->stallThresholdMs());
+        stallWatchdog->start(QThread::LowPriority);
+    } else if (!checked && stallWatchdog) {
+        delete stallWatchdog;
+        stallWatchdog = nullptr;
+    }
+}
+
+void MainWindow::actionExportMetricsToggled(bool checked)
+{
+    if (checked != settingsManager->metricsExportEnabled()) {
+        settingsManager->setMetricsExportEnabled(checked);
+        settingsManager->sync();
+    }
+    if (checked) {
+        metricsExporter->start(static_cast<quint16>(settingsManager->metricsPort()));
+    } else {
+        metricsExporter->stop();
+    }
+}
+
+void MainWindow::actionRecordTraceToggled(bool checked)
+{
+    if (checked) {
+        Tracer::start();
+        statusBar()->showMessage("Recording trace");
+        return;
+    }
+    auto tracePath = AppDataManager::getAppDataPath() + "/traces/trace-"
+                     + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".json";
+    if (!Tracer::stop(tracePath)) {
+        QMessageBox::warning(this, "Trace", "Could not write " + tracePath);
+        return;
+    }
+    QMessageBox::information(this, "Trace",
+                             "Trace written to " + tracePath + "\n\nOpen it in https://ui.perfetto.dev or chrome://tracing.");
+}
+
+void MainWindow::actionOpenStallReport()
+{
+    auto reportPath = AppDataManager::getAppDataPath() + "/stall-report.txt";
+    if (!QFileInfo::exists(reportPath)) {
+        QMessageBox::information(this, "UI Stalls", "No stalls have been recorded.");
+        return;
+    }
+    QDesktopServices::openUrl(QUrl::fromLocalFile(reportPath));
+}
+
+bool MainWindow::isIdle() const
+{
+    return idle;
+}
+
+void MainWindow::showEvent(QShowEvent *event)
+{
+    idleTimer->stop();
+    leaveIdleMode();
+    QMainWindow::showEvent(event);
+}
+
+void MainWindow::hideEvent(QHideEvent *event)
+{
+    idleTimer->start();
+    QMainWindow::hideEvent(event);
+}
+
+void MainWindow::enterIdleMode()
+{
+    if (idle || isVisible()) {
+        return;
+    }
+    // Feedback or a report may still be on its way
+    if (!isEnabled() || isBusy()) {
+        idleTimer->start();
+        return;
+    }
+    idle = true;
+    ui->menuHistory->clear();
+    ui->menuGenerateReport->clear();
+    ui->inputText->document()->clearUndoRedoStacks();
+    spellChecker->releaseDictionary();
+    translationMemory->unload();
+    appDataManager->searchIndex()->unload();
+    appDataManager->dayIndex()->unload();
+    QPixmapCache::clear();
+    NetworkThread::releaseIdleResources();
+    qDebug() << "Entered idle mode";
+    emit idleChanged(true);
+}
+
+void MainWindow::leaveIdleMode()
+{
+    if (!idle) {
+        return;
+    }
+    idle = false;
+    setupHistoryMenu();
+    spellChecker->setLanguage(ui->sourceLang->text());
+    emit idleChanged(false);
+}
+
 void MainWindow::setupHistoryMenu()
 {
+    StallWatchdog::Operation operation("MainWindow::setupHistoryMenu");
     // Clear existing history actions
     ui->menuHistory->clear();
     
@@ -347,7 +1088,7 @@ void MainWindow::setupHistoryMenu()
     
     if (history.isEmpty()) {
         // Add a disabled "No history" action
-        QAction *noHistoryAction = new QAction("No history", this);
+        QAction *noHistoryAction = new QAction("No history", ui->menuHistory);
         noHistoryAction->setEnabled(false);
         ui->menuHistory->addAction(noHistoryAction);
     } else {
@@ -357,7 +1098,8 @@ void MainWindow::setupHistoryMenu()
             // Truncate long messages for display
             QString displayText = message.length() > 50 ? message.left(47) + "..." : message;
             
-            QAction *historyAction = new QAction(displayText, this);
+            // Owned by the menu, so that clear() frees them on the next refresh
+            QAction *historyAction = new QAction(displayText, ui->menuHistory);
             historyAction->setData(message); // Store the full message
             historyAction->setToolTip(message); // Show full message in tooltip
             
@@ -387,59 +1129,47 @@ void MainWindow::onHistoryActionTriggered()
 
 void MainWindow::setupGenerateReportMenu()
 {
+    StallWatchdog::Operation operation("MainWindow::setupGenerateReportMenu");
     // Clear existing report actions
     ui->menuGenerateReport->clear();
     
-    // Get the app data path
-    QString appDataPath = AppDataManager::getAppDataPath();
-    QDir appDataDir(appDataPath);
+    // The most recent days with a log, straight from the day index
+    QList<DayInfo> recentDays = appDataManager->dayIndex()->recentDays(10);
     
-    // Get all .txt files in the app data directory
-    QStringList filters;
-    filters << "*.txt";
-    QFileInfoList files = appDataDir.entryInfoList(filters, QDir::Files, QDir::Time);
-    
-    // Create a list of available dates (last 10 days)
-    QList<QDate> availableDates;
-    QDate today = QDate::currentDate();
-    
-    // Check the last 10 days
-    for (int i = 0; i < 10; ++i) {
-        QDate checkDate = today.addDays(-i);
-        QString expectedFileName = checkDate.toString("yyyy-MM-dd") + ".txt";
-        
-        // Check if file exists
-        bool fileExists = false;
-        for (const QFileInfo &fileInfo : files) {
-            if (fileInfo.fileName() == expectedFileName) {
-                fileExists = true;
-                break;
-            }
-        }
-        
-        if (fileExists) {
-            availableDates.append(checkDate);
-        }
-    }
-    
-    if (availableDates.isEmpty()) {
+    if (recentDays.isEmpty()) {
         // Add a disabled "No data available" action
-        QAction *noDataAction = new QAction("No data available", this);
+        QAction *noDataAction = new QAction("No data available", ui->menuGenerateReport);
         noDataAction->setEnabled(false);
         ui->menuGenerateReport->addAction(noDataAction);
     } else {
         // Add actions for each available date
-        for (const QDate &date : availableDates) {
-            QString displayText = formatDateForDisplay(date);
-            QAction *reportAction = new QAction(displayText, this);
-            reportAction->setData(date.toString("yyyy-MM-dd")); // Store the date as data
+        for (const DayInfo &day : recentDays) {
+            QString displayText = formatDateForDisplay(day.date);
+            if (day.reportUpToDate()) {
+                displayText += " (report ready)";
+            }
+            QAction *reportAction = new QAction(displayText, ui->menuGenerateReport);
+            reportAction->setData(day.date.toString("yyyy-MM-dd")); // Store the date as data
             
             connect(reportAction, &QAction::triggered, this, &MainWindow::onGenerateReportActionTriggered);
             ui->menuGenerateReport->addAction(reportAction);
         }
+        ui->menuGenerateReport->addSeparator();
+        QAction *pickDayAction = new QAction("Other day...", ui->menuGenerateReport);
+        connect(pickDayAction, &QAction::triggered, this, &MainWindow::pickReportDay);
+        ui->menuGenerateReport->addAction(pickDayAction);
     }
 }
 
+void MainWindow::pickReportDay()
+{
+    auto dialog = new DayPickerDialog(appDataManager->dayIndex(), this);
+    connect(dialog, &DayPickerDialog::reportRequested, this, [=](const QString &dateString) {
+        generateReportForDate(dateString);
+    });
+    dialog->show();
+}
+
 QString MainWindow::formatDateForDisplay(const QDate &date)
 {
     int day = date.day();
@@ -477,6 +1207,15 @@ void MainWindow::onGenerateReportActionTriggered()
 
 void MainWindow::generateReportForDate(const QString &dateString)
 {
+    // Already prepared in the background
+    if (appDataManager->hasUpToDateReport(dateString)) {
+        QString reportPath = appDataManager->openableReportPath(dateString);
+        if (!reportPath.isEmpty()) {
+            QDesktopServices::openUrl(QUrl::fromLocalFile(reportPath));
+            return;
+        }
+    }
+
     if (openaiApiKey.isEmpty()) {
         QMessageBox::warning(this, "Error", "OpenAI API key is missing.");
         return;
@@ -487,7 +1226,11 @@ void MainWindow::generateReportForDate(const QString &dateString)
     auto openaiCommunicator = new OpenAICommunicator(openaiApiKey, this);
     progress->show();
 
-    auto fileContent = appDataManager->getFileContentForDate(dateString);
+    QString fileContent;
+    {
+        TRACE_SCOPE("report.read_log");
+        fileContent = appDataManager->getFileContentForDate(dateString);
+    }
     if (fileContent.isEmpty()) {
         cleanupProgressAndCommunicator(progress, openaiCommunicator);
         QMessageBox::warning(this, "Error", "Could not open file for " + dateString + ".");
@@ -498,15 +1241,22 @@ void MainWindow::generateReportForDate(const QString &dateString)
     QString promptTemplate = settingsManager->reportPrompt();
     QString prompt = promptTemplate.replace("%sourceLang", sourceLang);
     openaiCommunicator->setModelName(settingsManager->reportModelName());
-    openaiCommunicator->setPromptRaw(prompt + "\n\n" + fileContent);
+    openaiCommunicator->setPromptRaw(prompt);
+    openaiCommunicator->setInputText(fileContent);
+    openaiCommunicator->setResponseFormat(ResponseFormat::MistakeReport);
+    openaiCommunicator->setTask(Metrics::TaskReport);
+    Tracer::asyncBegin("report.pipeline", reinterpret_cast<quintptr>(openaiCommunicator), dateString);
     openaiCommunicator->sendRequest();
     
-    connect(openaiCommunicator, &OpenAICommunicator::replyReceived, this, [=](const QString &report) mutable {
+    connect(openaiCommunicator, &OpenAICommunicator::structuredReplyReceived, this, [=](const QJsonObject &result) mutable {
+        TRACE_SCOPE("report.write");
+        Tracer::asyncEnd("report.pipeline", reinterpret_cast<quintptr>(openaiCommunicator));
         cleanupProgressAndCommunicator(progress, openaiCommunicator);
-        appDataManager->writeMistakesReport(report, dateString);
+        appDataManager->writeMistakesReport(MistakeStore::recordsFromJson(result["mistakes"].toArray()), dateString);
     });
     
     connect(openaiCommunicator, &OpenAICommunicator::errorOccurred, this, [=](const QString &errorString) mutable {
+        Tracer::asyncEnd("report.pipeline", reinterpret_cast<quintptr>(openaiCommunicator));
         cleanupProgressAndCommunicator(progress, openaiCommunicator);
         QMessageBox::warning(this, "Network Error", errorString);
     });